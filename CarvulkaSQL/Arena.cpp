@@ -0,0 +1,85 @@
+#include "Arena.hpp"
+#include <new>
+
+using namespace std;
+
+void Arena::free()
+{
+    while (m_first_chunk != nullptr)
+    {
+        Chunk* next = m_first_chunk->next;
+        ::operator delete(m_first_chunk);
+        m_first_chunk = next;
+    }
+}
+
+char* Arena::memory_of(Chunk* chunk)
+{
+    return reinterpret_cast<char*>(chunk) + CHUNK_HEADER_SIZE;
+}
+
+Arena::Arena() : m_first_chunk(nullptr), m_curr_chunk(nullptr), m_curr_pos(0) {}
+
+Arena::~Arena() noexcept
+{
+    free();
+}
+
+void* Arena::allocate(size_t size, size_t alignment)
+{
+    if (m_curr_chunk != nullptr)
+    {
+        size_t pos = (m_curr_pos + alignment - 1) & ~(alignment - 1);
+        if (pos + size <= m_curr_chunk->capacity)
+        {
+            m_curr_pos = pos + size;
+            return memory_of(m_curr_chunk) + pos;
+        }
+        // the chunks behind the current one are left from before the last reset
+        while (m_curr_chunk->next != nullptr)
+        {
+            m_curr_chunk = m_curr_chunk->next;
+            if (size <= m_curr_chunk->capacity)
+            {
+                m_curr_pos = size;
+                return memory_of(m_curr_chunk);
+            }
+        }
+    }
+
+    size_t capacity = size > CHUNK_SIZE ? size : CHUNK_SIZE;
+    Chunk* chunk = static_cast<Chunk*>(::operator new(CHUNK_HEADER_SIZE + capacity));
+    chunk->next = nullptr;
+    chunk->capacity = capacity;
+    if (m_curr_chunk == nullptr)
+    {
+        m_first_chunk = chunk;
+    }
+    else
+    {
+        m_curr_chunk->next = chunk;
+    }
+    m_curr_chunk = chunk;
+    m_curr_pos = size;
+    return memory_of(chunk);
+}
+
+void Arena::reset()
+{
+    Chunk** link = &m_first_chunk;
+    while (*link != nullptr)
+    {
+        Chunk* chunk = *link;
+        if (chunk->capacity > CHUNK_SIZE)
+        {
+            *link = chunk->next;
+            ::operator delete(chunk);
+        }
+        else
+        {
+            link = &chunk->next;
+        }
+    }
+    m_curr_chunk = m_first_chunk;
+    m_curr_pos = 0;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+// hands out memory by bumping a position through chunks it keeps, for objects that all die together; nothing is freed on its own,
+// reset() takes everything back at once and keeps the chunks for the next round
+// a statement's temporaries are allocated in one, so that parsing and evaluating it doesn't go through the heap for each of them
+class Arena
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 16384;
+private:
+    struct Chunk
+    {
+        Chunk* next;
+        size_t capacity;
+    };
+    // the chunk is followed by its memory, which starts aligned as any object would be
+    static constexpr size_t CHUNK_HEADER_SIZE = (sizeof(Chunk) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    Chunk* m_first_chunk;
+    Chunk* m_curr_chunk;
+    size_t m_curr_pos;
+private:
+    void free();
+    static char* memory_of(Chunk* chunk);
+public:
+    Arena();
+
+    Arena(const Arena& other) = delete;
+    ~Arena() noexcept;
+    Arena& operator = (const Arena& other) = delete;
+
+    // @alignment: a power of 2, at most alignof(max_align_t)
+    void* allocate(size_t size, size_t alignment);
+    // everything allocated so far must be dead; chunks larger than CHUNK_SIZE are given back, so that one large statement doesn't hold on to its memory
+    void reset();
+};
\ No newline at end of file
@@ -1,16 +1,79 @@
 #include "SQLProxy.hpp"
+#include "Server.hpp"
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
 
 using namespace std;
 
-int main()
+static Server* running_server = nullptr;
+
+static void stop_running_server(int)
+{
+    if (running_server != nullptr)
+    {
+        running_server->stop();
+    }
+}
+
+// CarvulkaSQL [database path] [--serve [--socket path] [--port number] [--threads count]]
+// without --serve, the database is used from the console
+int main(int argc, char* argv[])
 {
-    /*
-    cout << "Enter database filepath: ";
-    char buffer[Database::BUFFER_SIZE];
-    cin.getline(buffer, Database::BUFFER_SIZE, ';');
-    cout << '\n';
-    */
-    Database db("bruh.db");
-    SQLProxy proxy(db);
-    proxy.run_console_interface();
+    const char* database_path = "bruh.db";
+    bool is_server = false;
+    const char* socket_path = Server::DEFAULT_SOCKET_PATH;
+    uint16_t port = Server::DEFAULT_PORT;
+    size_t executor_count = max(thread::hardware_concurrency(), 1u);
+    for (int i = 1; i < argc; i += 1)
+    {
+        if (strcmp(argv[i], "--serve") == 0)
+        {
+            is_server = true;
+        }
+        else if (strcmp(argv[i], "--socket") == 0 and i + 1 < argc)
+        {
+            i += 1;
+            socket_path = strcmp(argv[i], "none") == 0 ? nullptr : argv[i];
+        }
+        else if (strcmp(argv[i], "--port") == 0 and i + 1 < argc)
+        {
+            i += 1;
+            port = static_cast<uint16_t>(atoi(argv[i]));
+        }
+        else if (strcmp(argv[i], "--threads") == 0 and i + 1 < argc)
+        {
+            i += 1;
+            executor_count = static_cast<size_t>(atoi(argv[i]));
+        }
+        else
+        {
+            database_path = argv[i];
+        }
+    }
+
+    Database db(database_path);
+    if (not is_server)
+    {
+        SQLProxy proxy(db);
+        proxy.run_console_interface();
+        return 0;
+    }
+
+    try
+    {
+        Server server(db, socket_path, port, executor_count);
+        running_server = &server;
+        signal(SIGINT, stop_running_server);
+        signal(SIGTERM, stop_running_server);
+        cout << "serving '" << database_path << "'\n";
+        server.run();
+        running_server = nullptr;
+    }
+    catch (const exception& e)
+    {
+        cout << "server error: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "Cell.hpp"
+#include <cstring>
+#include <charconv>
 
 using namespace std;
 
@@ -32,9 +34,21 @@ String IntegerCell::convert_to_string() const
     return convert_integer_to_string(value);
 }
 
+void IntegerCell::append_to(String& text) const
+{
+    append_integer_to(text, value);
+}
+
 size_t IntegerCell::width() const
 {
-    return convert_to_string().size();
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    size_t width = value < 0 ? 2 : 1;
+    while (magnitude >= 10)
+    {
+        magnitude /= 10;
+        width += 1;
+    }
+    return width;
 }
 
 
@@ -51,19 +65,26 @@ String RealCell::convert_to_string() const
     return convert_real_to_string(value);
 }
 
+void RealCell::append_to(String& text) const
+{
+    append_real_to(text, value);
+}
+
 size_t RealCell::width() const
 {
-    return convert_to_string().size();
+    char buffer[MAX_REAL_LENGTH];
+    return write_real_to(buffer, value);
 }
 
 
 
-StringCell::StringCell(const StringView& value) : Cell(DataType::STRING), value(value) {}
-StringCell::StringCell(String&& value) : Cell(DataType::STRING), value(move(value)) {}
+StringCell::StringCell(const StringView& value) : Cell(DataType::STRING), value(value), dictionary_code(NO_DICTIONARY_CODE) {}
+StringCell::StringCell(String&& value) : Cell(DataType::STRING), value(move(value)), dictionary_code(NO_DICTIONARY_CODE) {}
 
 Cell* StringCell::clone() const
 {
-    return new StringCell(*this);
+    // the copy belongs to whoever asked for it, not to the dictionary
+    return new StringCell(value);
 }
 
 String StringCell::convert_to_string() const
@@ -71,6 +92,11 @@ String StringCell::convert_to_string() const
     return value;
 }
 
+void StringCell::append_to(String& text) const
+{
+    text.append(value);
+}
+
 size_t StringCell::width() const
 {
     return value.size();
@@ -105,142 +131,159 @@ partial_ordering compare(const Cell* lhs, const Cell* rhs)
     }
 }
 
-String convert_integer_to_string(Integer integer)
+uint64_t compute_hash_of(const Cell* cell)
 {
-    if (integer == 0) return String("0");
-    String string;
-    if (integer < 0)
+    if (cell == nullptr) return 0;
+
+    uint64_t bits = 0;
+    switch (cell->data_type)
+    {
+    case DataType::INTEGER:
     {
-        integer = -integer;
+        bits = static_cast<uint64_t>(static_cast<const IntegerCell*>(cell)->value);
+        break;
     }
-    while (integer > 0)
+    case DataType::REAL:
     {
-        string.append((integer % 10) + '0');
-        integer /= 10;
+        Real value = static_cast<const RealCell*>(cell)->value;
+        if (value == 0.0)
+        {
+            value = 0.0; // -0.0 and 0.0 compare equal
+        }
+        memcpy(&bits, &value, sizeof(bits));
+        break;
     }
-    if (integer < 0)
+    case DataType::STRING:
     {
-        string.append('-');
+        bits = case_insensitive_hash(static_cast<const StringCell*>(cell)->value);
+        break;
     }
-    string.reverse();
-    return string;
+    default:
+    {
+        break;
+    }
+    }
+    // splitmix64 finalizer, so that consecutive integers spread over every bit
+    bits ^= bits >> 30;
+    bits *= 0xbf58476d1ce4e5b9ull;
+    bits ^= bits >> 27;
+    bits *= 0x94d049bb133111ebull;
+    bits ^= bits >> 31;
+    return bits;
 }
 
-String convert_real_to_string(Real real)
+// "00" to "99", so that the digits of an integer are written two at a time
+static constexpr char DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+size_t write_integer_to(char* buffer, Integer integer)
 {
-    Real epsilon = 0.00001; // 5 decimal place precision
-    if (real - static_cast<int64_t>(real) < epsilon) return convert_integer_to_string(static_cast<Integer>(real));
-    if (real < 0)
+    // the digits are written from the back of a scratch buffer, then moved to the front of @buffer
+    char digits[MAX_INTEGER_LENGTH];
+    char* first = digits + MAX_INTEGER_LENGTH;
+    uint64_t magnitude = integer < 0 ? 0 - static_cast<uint64_t>(integer) : static_cast<uint64_t>(integer);
+    while (magnitude >= 100)
     {
-        real = -real;
+        size_t pair_pos = 2 * (magnitude % 100);
+        magnitude /= 100;
+        first -= 2;
+        first[0] = DIGIT_PAIRS[pair_pos];
+        first[1] = DIGIT_PAIRS[pair_pos + 1];
     }
-    String string = convert_integer_to_string(static_cast<Integer>(real)).append('.');
-    Real fractional_part = real - static_cast<Integer>(real);
-    for (size_t i = 0; i < 5; i += 1) // 5 decimal place precision
+    if (magnitude >= 10)
     {
-        fractional_part *= 10;
-        string.append((static_cast<Integer>(fractional_part) % 10) + '0');
-
+        first -= 2;
+        first[0] = DIGIT_PAIRS[2 * magnitude];
+        first[1] = DIGIT_PAIRS[2 * magnitude + 1];
     }
-    return string;
-}
-
-Integer convert_string_to_integer(const StringView& string)
-{
-    Integer n = 0;
-    bool is_negative = false;
-
-    for (size_t i = 0; i < string.size(); i += 1)
+    else
     {
-        if (i == 0 and string[i] == '+')
-        {
-            is_negative = false;
-            continue;
-        }
-
-        if (i == 0 and string[i] == '-')
-        {
-            is_negative = true;
-            continue;
-        }
-
-        if (Char::is_digit(string[i]))
-        {
-            n *= 10;
-            n += string[i] - '0';
-            continue;
-        }
-
-        throw exception("string is not convertible to integer");
+        first -= 1;
+        first[0] = static_cast<char>('0' + magnitude);
     }
-
-    if (is_negative)
+    if (integer < 0)
     {
-        n = -n;
+        first -= 1;
+        first[0] = '-';
     }
 
-    return n;
+    size_t length = digits + MAX_INTEGER_LENGTH - first;
+    memcpy(buffer, first, length);
+    return length;
+}
+String convert_integer_to_string(Integer integer)
+{
+    String string;
+    append_integer_to(string, integer);
+    return string;
+}
+void append_integer_to(String& string, Integer integer)
+{
+    char buffer[MAX_INTEGER_LENGTH];
+    size_t length = write_integer_to(buffer, integer);
+    string.append(StringView(buffer, length));
 }
 
-Real convert_string_to_real(const StringView& string)
+size_t write_real_to(char* buffer, Real real)
 {
-    Real whole_part = 0.0;
-    Real fractional_part = 0.0;
-    bool is_negative = false;
-    bool has_decimal_point = false;
-    size_t fractional_part_digits = 0;
+    // without a format, to_chars writes the shortest text that reads back as the same double
+    char* last = to_chars(buffer, buffer + MAX_REAL_LENGTH - 2, real).ptr;
+    size_t length = last - buffer;
 
-    for (size_t i = 0; i < string.size(); i++)
+    // a real written as digits alone would be read back as an integer
+    for (size_t i = 0; i < length; i += 1)
     {
-        if (i == 0 and string[i] == '+')
-        {
-            is_negative = false;
-            continue;
-        }
-
-        if (i == 0 and string[i] == '-')
-        {
-            is_negative = true;
-            continue;
-        }
-
-        if (string[i] == '.' and !has_decimal_point)
-        {
-            has_decimal_point = true;
-            continue;
-        }
-
-        if (Char::is_digit(string[i]))
-        {
-            if (!has_decimal_point)
-            {
-                whole_part *= 10;
-                whole_part += string[i] - '0';
-            }
-            else
-            {
-                fractional_part *= 10;
-                fractional_part += string[i] - '0';
-                fractional_part_digits += 1;
-            }
-            continue;
-        }
-
-        throw exception("string is not convertible to real");
+        if (not Char::is_digit(buffer[i]) and buffer[i] != '-') return length;
     }
+    buffer[length] = '.';
+    buffer[length + 1] = '0';
+    return length + 2;
+}
+String convert_real_to_string(Real real)
+{
+    String string;
+    append_real_to(string, real);
+    return string;
+}
+void append_real_to(String& string, Real real)
+{
+    char buffer[MAX_REAL_LENGTH];
+    size_t length = write_real_to(buffer, real);
+    string.append(StringView(buffer, length));
+}
 
-    if (has_decimal_point)
+Integer convert_string_to_integer(const StringView& string)
+{
+    // from_chars doesn't take a leading '+'
+    const char* first = string.data();
+    const char* last = string.data() + string.size();
+    if (first != last and *first == '+' and first + 1 != last and *(first + 1) != '-')
     {
-        fractional_part /= pow(10, fractional_part_digits);
+        first += 1;
     }
 
-    if (is_negative)
+    Integer integer;
+    from_chars_result result = from_chars(first, last, integer);
+    if (result.ec != errc() or result.ptr != last) throw exception("string is not convertible to integer");
+    return integer;
+}
+
+Real convert_string_to_real(const StringView& string)
+{
+    const char* first = string.data();
+    const char* last = string.data() + string.size();
+    if (first != last and *first == '+' and first + 1 != last and *(first + 1) != '-')
     {
-        whole_part = -whole_part;
-        fractional_part = -fractional_part;
+        first += 1;
     }
 
-    return whole_part + fractional_part;
+    // exact: the result is the double nearest to the decimal, however many digits it has
+    Real real;
+    from_chars_result result = from_chars(first, last, real);
+    if (result.ec != errc() or result.ptr != last) throw exception("string is not convertible to real");
+    return real;
 }
 
 String convert_data_type_to_string(DataType data_type)
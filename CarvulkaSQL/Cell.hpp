@@ -15,9 +15,12 @@ struct Cell
     DataType data_type;
 
     Cell(DataType data_type);
+    virtual ~Cell() = default;
 
     virtual Cell* clone() const = 0;
     virtual String convert_to_string() const = 0;
+    // appends the text convert_to_string() returns, for rendering many cells into one buffer
+    virtual void append_to(String& text) const = 0;
     virtual size_t width() const = 0;
 };
 
@@ -29,6 +32,7 @@ struct IntegerCell : public Cell
 
     Cell* clone() const override;
     String convert_to_string() const override;
+    void append_to(String& text) const override;
     size_t width() const override;
 };
 
@@ -40,26 +44,46 @@ struct RealCell : public Cell
 
     Cell* clone() const override;
     String convert_to_string() const override;
+    void append_to(String& text) const override;
     size_t width() const override;
 };
 
+// the code of a cell that no dictionary shares, see StringDictionary
+constexpr uint32_t NO_DICTIONARY_CODE = -1;
+
 struct StringCell : public Cell
 {
     String value;
+    uint32_t dictionary_code;
 
     StringCell(const StringView& value);
     StringCell(String&& value);
 
     Cell* clone() const override;
     String convert_to_string() const override;
+    void append_to(String& text) const override;
     size_t width() const override;
 };
 
 std::partial_ordering compare(const Cell* lhs, const Cell* rhs);
 
+// cells that compare equivalent hash equal; null hashes to 0
+uint64_t compute_hash_of(const Cell* cell);
+
+// the most characters write_integer_to and write_real_to write
+constexpr size_t MAX_INTEGER_LENGTH = 20;
+constexpr size_t MAX_REAL_LENGTH = 32;
+
+// these write into @buffer without terminating it and return how many characters they wrote
+size_t write_integer_to(char* buffer, Integer integer);
+// the shortest text that reads back as @real, always with a '.' or an exponent so that it isn't read back as an integer
+size_t write_real_to(char* buffer, Real real);
+
 String convert_integer_to_string(Integer integer);
+void append_integer_to(String& string, Integer integer);
 
 String convert_real_to_string(Real real);
+void append_real_to(String& string, Real real);
 
 Integer convert_string_to_integer(const StringView& string);
 
@@ -0,0 +1,101 @@
+#include "CellPool.hpp"
+
+using namespace std;
+
+CellPool::CellPool() : m_integer_cells(), m_real_cells(), m_string_cells() {}
+
+CellPool::CellPool(CellPool&& other) noexcept : m_integer_cells(move(other.m_integer_cells)), m_real_cells(move(other.m_real_cells)), m_string_cells(move(other.m_string_cells)) {}
+CellPool& CellPool::operator = (CellPool&& other) noexcept
+{
+    if (this != &other)
+    {
+        m_integer_cells = move(other.m_integer_cells);
+        m_real_cells = move(other.m_real_cells);
+        m_string_cells = move(other.m_string_cells);
+    }
+    return *this;
+}
+
+size_t CellPool::cell_count() const
+{
+    return m_integer_cells.size() + m_real_cells.size() + m_string_cells.size();
+}
+size_t CellPool::used_bytes() const
+{
+    return m_integer_cells.used_bytes() + m_real_cells.used_bytes() + m_string_cells.used_bytes();
+}
+size_t CellPool::reserved_bytes() const
+{
+    return m_integer_cells.reserved_bytes() + m_real_cells.reserved_bytes() + m_string_cells.reserved_bytes();
+}
+
+Cell* CellPool::copy_of(const Cell* cell)
+{
+    if (cell == nullptr) return nullptr;
+    switch (cell->data_type)
+    {
+    case DataType::INTEGER:
+    {
+        return m_integer_cells.create(static_cast<const IntegerCell*>(cell)->value);
+    }
+    case DataType::REAL:
+    {
+        return m_real_cells.create(static_cast<const RealCell*>(cell)->value);
+    }
+    case DataType::STRING:
+    {
+        return m_string_cells.create(StringView(static_cast<const StringCell*>(cell)->value));
+    }
+    default:
+    {
+        throw exception("invalid data type");
+    }
+    }
+}
+Cell* CellPool::adopt(Cell* cell)
+{
+    if (cell == nullptr) return nullptr;
+    Cell* pooled_cell = nullptr;
+    if (cell->data_type == DataType::STRING)
+    {
+        pooled_cell = m_string_cells.create(move(static_cast<StringCell*>(cell)->value));
+    }
+    else
+    {
+        pooled_cell = copy_of(cell);
+    }
+    delete cell;
+    return pooled_cell;
+}
+void CellPool::destroy(const Cell* cell)
+{
+    if (cell == nullptr) return;
+    switch (cell->data_type)
+    {
+    case DataType::INTEGER:
+    {
+        m_integer_cells.destroy(static_cast<const IntegerCell*>(cell));
+        break;
+    }
+    case DataType::REAL:
+    {
+        m_real_cells.destroy(static_cast<const RealCell*>(cell));
+        break;
+    }
+    case DataType::STRING:
+    {
+        m_string_cells.destroy(static_cast<const StringCell*>(cell));
+        break;
+    }
+    default:
+    {
+        break;
+    }
+    }
+}
+void CellPool::clear()
+{
+    m_integer_cells.clear();
+    m_real_cells.clear();
+    m_string_cells.clear();
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "SlabPool.hpp"
+#include "Cell.hpp"
+
+// the cells of a table, in a slab pool per type, so that its rows don't take an allocation per value and truncating it gives the slabs back at once
+// owns every cell it created, those the table's dictionaries share included; only the writer may use it, like the rows
+class CellPool
+{
+private:
+    SlabPool<IntegerCell> m_integer_cells;
+    SlabPool<RealCell> m_real_cells;
+    SlabPool<StringCell> m_string_cells;
+public:
+    CellPool();
+
+    CellPool(const CellPool& other) = delete;
+    CellPool(CellPool&& other) noexcept;
+    CellPool& operator = (const CellPool& other) = delete;
+    CellPool& operator = (CellPool&& other) noexcept;
+
+    size_t cell_count() const;
+    // the bytes the cells take in the slabs; a string longer than fits in its cell takes its bytes from the heap besides
+    size_t used_bytes() const;
+    size_t reserved_bytes() const;
+
+    // a copy of @cell in the pool; nullptr for null
+    Cell* copy_of(const Cell* cell);
+    // replaces @cell, allocated with new, with a cell in the pool holding its value; nullptr for null
+    Cell* adopt(Cell* cell);
+    // @cell must be from the pool or null
+    void destroy(const Cell* cell);
+    void clear();
+};
\ No newline at end of file
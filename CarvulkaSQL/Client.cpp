@@ -0,0 +1,160 @@
+#include "Client.hpp"
+#include <string>
+
+using namespace std;
+
+/* ResultSet */
+
+ResultSet::ResultSet(Selection&& selection, String&& message) : m_selection(move(selection)), m_message(move(message)), m_row_pos(-1) {}
+
+const Cell* ResultSet::cell_at(size_t column_pos, DataType data_type) const
+{
+    if (m_row_pos == -1 or m_row_pos >= row_count()) throw exception("no current row");
+    if (column_pos >= column_count()) throw exception("column out of range");
+    const Cell* cell = m_selection.rows()[m_row_pos][column_pos];
+    if (cell == nullptr) throw exception("value is null");
+    if (cell->data_type != data_type) throw exception("value is of another type");
+    return cell;
+}
+
+const String& ResultSet::message() const
+{
+    return m_message;
+}
+
+size_t ResultSet::column_count() const
+{
+    return m_selection.columns().size();
+}
+const String& ResultSet::column_name(size_t column_pos) const
+{
+    return m_selection.columns()[column_pos].name();
+}
+DataType ResultSet::column_type(size_t column_pos) const
+{
+    return m_selection.columns()[column_pos].data_type();
+}
+size_t ResultSet::find_column(const StringView& column_name) const
+{
+    for (size_t i = 0; i < column_count(); i += 1)
+    {
+        if (m_selection.columns()[i].name() == column_name) return i;
+    }
+    return -1;
+}
+
+size_t ResultSet::row_count() const
+{
+    return m_selection.rows().size();
+}
+bool ResultSet::next()
+{
+    if (m_row_pos == row_count()) return false;
+    m_row_pos += 1;
+    return m_row_pos < row_count();
+}
+void ResultSet::rewind()
+{
+    m_row_pos = -1;
+}
+
+bool ResultSet::is_null(size_t column_pos) const
+{
+    if (m_row_pos == -1 or m_row_pos >= row_count()) throw exception("no current row");
+    if (column_pos >= column_count()) throw exception("column out of range");
+    return m_selection.rows()[m_row_pos][column_pos] == nullptr;
+}
+Integer ResultSet::get_integer(size_t column_pos) const
+{
+    return static_cast<const IntegerCell*>(cell_at(column_pos, DataType::INTEGER))->value;
+}
+Real ResultSet::get_real(size_t column_pos) const
+{
+    return static_cast<const RealCell*>(cell_at(column_pos, DataType::REAL))->value;
+}
+const String& ResultSet::get_string(size_t column_pos) const
+{
+    return static_cast<const StringCell*>(cell_at(column_pos, DataType::STRING))->value;
+}
+
+/* Statement */
+
+Statement::Statement(Connection& connection, const StringView& statement) : m_connection(connection), m_pieces(), m_values()
+{
+    size_t piece_start_pos = 0;
+    bool is_in_literal = false;
+    for (size_t i = 0; i < statement.size(); i += 1)
+    {
+        if (statement[i] == '\'')
+        {
+            is_in_literal = not is_in_literal;
+        }
+        else if (statement[i] == '?' and not is_in_literal)
+        {
+            m_pieces.append(statement.slice(piece_start_pos, i));
+            m_values.append(String());
+            piece_start_pos = i + 1;
+        }
+    }
+    m_pieces.append(statement.slice(piece_start_pos, statement.size()));
+}
+
+size_t Statement::parameter_count() const
+{
+    return m_values.size();
+}
+Statement& Statement::bind(size_t parameter_pos, Integer value)
+{
+    if (parameter_pos >= parameter_count()) throw exception("parameter out of range");
+    m_values[parameter_pos] = convert_integer_to_string(value);
+    return *this;
+}
+Statement& Statement::bind(size_t parameter_pos, Real value)
+{
+    if (parameter_pos >= parameter_count()) throw exception("parameter out of range");
+    m_values[parameter_pos] = convert_real_to_string(value);
+    return *this;
+}
+Statement& Statement::bind(size_t parameter_pos, const StringView& value)
+{
+    if (parameter_pos >= parameter_count()) throw exception("parameter out of range");
+    if (value.contains('\'')) throw exception("strings can't contain quotes");
+    m_values[parameter_pos] = String("'").append(value).append('\'');
+    return *this;
+}
+Statement& Statement::bind_null(size_t parameter_pos)
+{
+    if (parameter_pos >= parameter_count()) throw exception("parameter out of range");
+    m_values[parameter_pos] = String("null");
+    return *this;
+}
+
+ResultSet Statement::execute()
+{
+    String statement = m_pieces[0];
+    for (size_t i = 0; i < m_values.size(); i += 1)
+    {
+        if (m_values[i].is_empty()) throw exception("parameter not bound");
+        // spaced out, so that a value never runs into the text around it
+        statement.append(' ').append(m_values[i]).append(' ').append(m_pieces[i + 1]);
+    }
+    return m_connection.execute(statement);
+}
+
+/* Connection */
+
+Connection::Connection(Database& database) : m_session(database) {}
+
+ResultSet Connection::execute(const StringView& statement)
+{
+    SQLResponse response = m_session.execute(statement);
+    if (response.is_error()) throw exception(std::string(response.message().data(), response.message().size()).c_str());
+    // read to the end right away, since the cursor holds latches that later statements of the session may need
+    Selection selection = response.has_selection() ? response.cursor().fetch_all() : Selection();
+    return ResultSet(move(selection), String(response.message()));
+}
+
+Statement Connection::prepare(const StringView& statement)
+{
+    return Statement(*this, statement);
+}
\ No newline at end of file
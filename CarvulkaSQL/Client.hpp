@@ -0,0 +1,82 @@
+#pragma once
+
+#include "SQLProxy.hpp"
+
+// the in-process API for programs that embed the engine: results come back as typed cells instead of printed text
+// a Connection is a session of its own, like a connection to the server, so a transaction begun on it stays on it
+
+// the rows a statement selected, read like a cursor: next() moves to the first row, then to each one after it
+// the cells are copies, so a result set stays valid after the tables it was selected from change
+class ResultSet
+{
+private:
+    Selection m_selection;
+    String m_message;
+    size_t m_row_pos; // -1 before the first row
+private:
+    // throws if there is no current row, @column_pos is out of range, or the cell is null or of another type
+    const Cell* cell_at(size_t column_pos, DataType data_type) const;
+public:
+    ResultSet(Selection&& selection, String&& message);
+
+    // the message the statement reported, which is all a statement that selects nothing returns
+    const String& message() const;
+
+    size_t column_count() const;
+    const String& column_name(size_t column_pos) const;
+    DataType column_type(size_t column_pos) const;
+    // returns -1 if there is no such column
+    size_t find_column(const StringView& column_name) const;
+
+    size_t row_count() const;
+    // returns false once every row was read
+    bool next();
+    // moves back before the first row
+    void rewind();
+
+    bool is_null(size_t column_pos) const;
+    Integer get_integer(size_t column_pos) const;
+    Real get_real(size_t column_pos) const;
+    const String& get_string(size_t column_pos) const;
+};
+
+class Connection;
+
+// a statement that can be executed any number of times, with a value bound to each '?' outside of its string literals
+class Statement
+{
+private:
+    Connection& m_connection;
+    // the text around the parameters, one more piece than there are parameters
+    Vector<String> m_pieces;
+    // the literals bound to the parameters, empty until bound
+    Vector<String> m_values;
+public:
+    Statement(Connection& connection, const StringView& statement);
+
+    size_t parameter_count() const;
+    // @parameter_pos counts from 0
+    Statement& bind(size_t parameter_pos, Integer value);
+    Statement& bind(size_t parameter_pos, Real value);
+    // throws if @value contains a quote, which string literals can't
+    Statement& bind(size_t parameter_pos, const StringView& value);
+    Statement& bind_null(size_t parameter_pos);
+
+    // throws if a parameter isn't bound or the statement fails; bound values stay bound
+    ResultSet execute();
+};
+
+class Connection
+{
+private:
+    SQLProxy m_session;
+public:
+    Connection(Database& database);
+
+    Connection(const Connection& other) = delete;
+    Connection& operator = (const Connection& other) = delete;
+
+    // @statement without its terminating ';'; throws with the reported message if the statement fails
+    ResultSet execute(const StringView& statement);
+    Statement prepare(const StringView& statement);
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "Cursor.hpp"
+
+using namespace std;
+
+/* Cursor */
+
+Selection Cursor::fetch_all()
+{
+    Selection selection(columns());
+    Selection batch(columns());
+    while (fetch_into(batch))
+    {
+        for (size_t i = 0; i < batch.rows().size(); i += 1)
+        {
+            selection.append_row(batch.release_row(i));
+        }
+    }
+    return selection;
+}
+
+/* SelectionCursor */
+
+SelectionCursor::SelectionCursor(Selection&& selection) : m_selection(move(selection)), m_next_row_pos(0) {}
+
+const Vector<Column>& SelectionCursor::columns() const
+{
+    return m_selection.columns();
+}
+
+bool SelectionCursor::fetch_into(Selection& batch)
+{
+    batch.clear_rows();
+    size_t end_row_pos = min(m_next_row_pos + BATCH_SIZE, m_selection.rows().size());
+    for (; m_next_row_pos < end_row_pos; m_next_row_pos += 1)
+    {
+        batch.append_row(m_selection.release_row(m_next_row_pos));
+    }
+    return not batch.rows().is_empty();
+}
+
+/* TableScanCursor */
+
+TableScanCursor::TableScanCursor(SnapshotGuard&& guard, const Table& table, const Vector<String>& column_names, Function<bool, Vector<Cell*>>&& condition,
+    bool is_index_scan, Vector<size_t>&& candidate_row_positions) : m_guard(move(guard)), m_table(table), m_columns(), m_column_indices(), m_condition(move(condition)),
+    m_is_index_scan(is_index_scan), m_candidate_row_positions(move(candidate_row_positions)), m_row_count(0), m_next_pos(0)
+{
+    m_column_indices = move(table.map_column_names_to_indices(column_names));
+    m_columns.resize_capacity_to(m_column_indices.size());
+    for (size_t i = 0; i < m_column_indices.size(); i += 1)
+    {
+        m_columns.append(table.columns()[m_column_indices[i]]);
+    }
+    // a selection naming no existing column selects nothing
+    if (m_column_indices.is_empty()) return;
+    m_row_count = m_is_index_scan ? m_candidate_row_positions.size() : table.row_count();
+}
+
+const Vector<Column>& TableScanCursor::columns() const
+{
+    return m_columns;
+}
+
+bool TableScanCursor::fetch_into(Selection& batch)
+{
+    batch.clear_rows();
+    const Snapshot& snapshot = m_guard.snapshot();
+    while (m_next_pos < m_row_count and batch.rows().size() < BATCH_SIZE)
+    {
+        size_t row_pos = m_is_index_scan ? m_candidate_row_positions[m_next_pos] : m_next_pos;
+        m_next_pos += 1;
+        // index candidates were only found among the visible rows
+        if (not m_is_index_scan and not snapshot.can_see(m_table.version(row_pos))) continue;
+        if (m_condition(m_table.row(row_pos)))
+        {
+            batch.append_row_from(m_table.row(row_pos), m_column_indices);
+        }
+    }
+    return not batch.rows().is_empty();
+}
\ No newline at end of file
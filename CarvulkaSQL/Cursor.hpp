@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Selection.hpp"
+#include "Database.hpp"
+
+// hands out the rows a statement selected a batch at a time, so that the first ones can be written out while the rest are still being read
+class Cursor
+{
+public:
+    static constexpr size_t BATCH_SIZE = 1024;
+public:
+    virtual ~Cursor() = default;
+
+    // empty if the selection named no existing column
+    virtual const Vector<Column>& columns() const = 0;
+    // replaces the rows of @batch with the next ones, at most BATCH_SIZE of them; returns false once every row was handed out
+    virtual bool fetch_into(Selection& batch) = 0;
+
+    // collects the rows that weren't handed out yet
+    Selection fetch_all();
+};
+
+// over rows that had to be collected before the first one could be handed out, for joins and ordered selections
+class SelectionCursor : public Cursor
+{
+private:
+    Selection m_selection;
+    size_t m_next_row_pos;
+public:
+    SelectionCursor(Selection&& selection);
+
+    const Vector<Column>& columns() const override;
+    bool fetch_into(Selection& batch) override;
+};
+
+// reads the rows of a single table in place, through the snapshot of the statement that opened it
+// holds the statement's latches until it is destroyed, so a schema change to the table waits until the rows were read
+class TableScanCursor : public Cursor
+{
+private:
+    SnapshotGuard m_guard;
+    const Table& m_table;
+    Vector<Column> m_columns;
+    Vector<size_t> m_column_indices;
+    Function<bool, Vector<Cell*>> m_condition;
+    // reads only the candidates an index found if set, every row up to m_row_count otherwise
+    bool m_is_index_scan;
+    Vector<size_t> m_candidate_row_positions;
+    // rows appended after the cursor was opened belong to later transactions
+    size_t m_row_count;
+    size_t m_next_pos;
+public:
+    TableScanCursor(SnapshotGuard&& guard, const Table& table, const Vector<String>& column_names, Function<bool, Vector<Cell*>>&& condition,
+        bool is_index_scan, Vector<size_t>&& candidate_row_positions);
+
+    const Vector<Column>& columns() const override;
+    bool fetch_into(Selection& batch) override;
+};
\ No newline at end of file
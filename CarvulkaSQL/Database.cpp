@@ -1,21 +1,185 @@
 #include "Database.hpp"
 #include "SQLParsingUtils.hpp"
 #include <fstream>
+#include <sstream>
+#include <algorithm>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 using namespace std;
 
-Database::Database(const char* path) : m_name(), m_tables()
+// keeps the writer and the statements using a table out while its layout changes, taking the writer's right first like statements do
+class SchemaChangeGuard
 {
-    load_database_from(path);
+private:
+    TransactionManager& m_transactions;
+    Snapshot m_snapshot;
+    Latch& m_catalog_latch;
+    Latch* m_table_latch; // nullptr while the catalog itself changes
+    size_t m_table_pos;
+public:
+    // for adding, removing or renaming tables, which keeps out every statement
+    SchemaChangeGuard(Database& database) : m_transactions(database.m_transactions), m_snapshot(m_transactions.begin_write()),
+        m_catalog_latch(database.m_catalog_latch), m_table_latch(nullptr), m_table_pos(-1)
+    {
+        m_catalog_latch.lock();
+    }
+    // for changing the table named @table_name, which leaves the others to the statements using them; throws @missing_table_error if there is none
+    SchemaChangeGuard(Database& database, const StringView& table_name, const char* missing_table_error = "table pos out of bounds") : m_transactions(database.m_transactions),
+        m_snapshot(m_transactions.begin_write()), m_catalog_latch(database.m_catalog_latch), m_table_latch(nullptr), m_table_pos(-1)
+    {
+        m_catalog_latch.lock_shared();
+        m_table_pos = database.find_table_by_name(table_name);
+        if (m_table_pos == -1)
+        {
+            m_catalog_latch.unlock_shared();
+            m_transactions.finish_write(m_snapshot);
+            throw exception(missing_table_error);
+        }
+        m_table_latch = &database.m_tables[m_table_pos].latch();
+        m_table_latch->lock();
+    }
+    ~SchemaChangeGuard() noexcept
+    {
+        if (m_table_latch == nullptr)
+        {
+            m_catalog_latch.unlock();
+        }
+        else
+        {
+            m_table_latch->unlock();
+            m_catalog_latch.unlock_shared();
+        }
+        m_transactions.finish_write(m_snapshot);
+    }
+
+    const Snapshot& snapshot() const
+    {
+        return m_snapshot;
+    }
+    // the table changed alone
+    size_t table_pos() const
+    {
+        return m_table_pos;
+    }
+};
+
+static FILE* open_for_appending(const char* path)
+{
+#ifdef _WIN32
+    FILE* file = nullptr;
+    if (fopen_s(&file, path, "ab") != 0) return nullptr;
+    return file;
+#else
+    return fopen(path, "ab");
+#endif
+}
+// flushed data may still sit in the OS's cache; this returns once it's on the disk
+static bool sync_to_disk(FILE* file)
+{
+    if (fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+/* Transaction */
+
+Transaction::Transaction(const Snapshot& snapshot) : snapshot(snapshot), undo_log() {}
+
+void Transaction::log(size_t table_pos, const Vector<RowChange>& changes)
+{
+    for (size_t i = 0; i < changes.size(); i += 1)
+    {
+        undo_log.append(UndoRecord{ table_pos, changes[i] });
+    }
+}
+Vector<size_t> Transaction::changed_table_positions() const
+{
+    Vector<size_t> table_positions;
+    for (size_t i = 0; i < undo_log.size(); i += 1)
+    {
+        if (table_positions.find(undo_log[i].table_pos) == -1)
+        {
+            table_positions.append(undo_log[i].table_pos);
+        }
+    }
+    return table_positions;
 }
 
-void Database::load_database_from(const char* path)
+/* Database */
+
+Database::Database(const char* path) : m_name(), m_tables(), m_table_names(), m_catalog_latch(), m_transactions(), m_purge_thread(), m_purge_mutex(), m_purge_condition(), m_is_closing(false), m_journal(nullptr), m_last_lsn(0)
+{
+    if (load_database_from(path))
+    {
+        // a journal restarted after it was lost must not number its transactions below what the tables were saved with
+        for (size_t i = 0; i < m_tables.size(); i += 1)
+        {
+            m_last_lsn = max(m_last_lsn, m_tables[i].journal_lsn());
+        }
+
+        char journal_path[BUFFER_SIZE];
+        snprintf(journal_path, BUFFER_SIZE, "%s.journal", path);
+        replay_journal(journal_path);
+        m_journal = open_for_appending(journal_path);
+        if (m_journal == nullptr)
+        {
+            cout << "journal could not be opened, changes will not outlive the session\n\n";
+        }
+    }
+    m_purge_thread = thread(&Database::run_purge_loop, this);
+}
+Database::~Database() noexcept
+{
+    {
+        lock_guard<mutex> lock(m_purge_mutex);
+        m_is_closing = true;
+    }
+    m_purge_condition.notify_one();
+    m_purge_thread.join();
+    if (m_journal != nullptr)
+    {
+        fclose(m_journal);
+    }
+}
+
+void Database::run_purge_loop()
+{
+    unique_lock<mutex> lock(m_purge_mutex);
+    while (not m_purge_condition.wait_for(lock, PURGE_INTERVAL, [this]() -> bool { return m_is_closing; }))
+    {
+        try_purge();
+    }
+}
+void Database::try_purge()
+{
+    // purging moves rows, which no statement may be reading; a table in use is tried again next round rather than making statements wait
+    shared_lock<Latch> catalog_lock(m_catalog_latch, try_to_lock);
+    if (not catalog_lock.owns_lock()) return;
+
+    for (size_t i = 0; i < m_tables.size(); i += 1)
+    {
+        unique_lock<Latch> table_lock(m_tables[i].latch(), try_to_lock);
+        if (not table_lock.owns_lock() or not m_tables[i].has_deleted_versions()) continue;
+        // no statement uses the table, and those that will take their snapshots after latching it,
+        // so no snapshot reading it is older than the last finished transaction
+        m_tables[i].purge_versions_deleted_by(m_transactions.last_finished_id());
+    }
+}
+
+bool Database::load_database_from(const char* path)
 {
     ifstream ifs(path);
     if (not ifs.is_open())
     {
         cout << "database not found\n\n";
-        return;
+        return false;
     }
     char buffer[BUFFER_SIZE];
 
@@ -26,6 +190,7 @@ void Database::load_database_from(const char* path)
     {
         load_table_from(buffer);
     }
+    return true;
 }
 
 void Database::load_table_from(const char* path)
@@ -48,7 +213,7 @@ void Database::load_table_from(const char* path)
     combine_keyword_tokens(tokens);
 
     Vector<Column> columns;
-    try { columns = move(parse_column_definitions_clause(tokens.slice(0, tokens.size()))); }
+    try { columns = move(parse_column_definitions_clause(tokens)); }
     catch (const exception& e)
     {
         cout << "error reading from file: " << e.what() << '\n';
@@ -56,7 +221,9 @@ void Database::load_table_from(const char* path)
     }
 
     Table table(name, columns);
-    // every next line is a row
+    TableAnalysis analysis;
+    size_t analysis_column_pos = -1;
+    // every next line is a row, until the directives describing the table's indexes and analysis
     while (ifs.getline(buffer, BUFFER_SIZE, '\n'))
     {
         list = buffer;
@@ -64,15 +231,28 @@ void Database::load_table_from(const char* path)
         tokens = move(tokenize(list));
         combine_keyword_tokens(tokens);
 
+        if (buffer[0] == '@')
+        {
+            try { parse_table_directive(tokens, table, analysis, analysis_column_pos); }
+            catch (const exception& e)
+            {
+                cout << "error reading from file: " << e.what() << '\n';
+                analysis = TableAnalysis();
+                break;
+            }
+            continue;
+        }
+
         Vector<Cell*> row;
-        try { row = move(parse_row(tokens.slice(0, tokens.size()))); }
+        try { row = move(parse_row(tokens)); }
         catch (const exception& e)
         {
             Table::free_row(row);
             cout << "error reading from file: " << e.what() << '\n';
             continue;
         }
-        try { table.insert(move(row)); }
+        // rows read from a file predate every transaction
+        try { table.insert(move(row), NO_TRANSACTION); }
         catch (const exception& e)
         {
             Table::free_row(row);
@@ -80,191 +260,717 @@ void Database::load_table_from(const char* path)
             continue;
         }
     }
+    table.set_analysis(move(analysis));
+
+    SchemaChangeGuard guard(*this);
     m_tables.append(move(table));
+    m_table_names.append(m_tables.back().name());
 }
 
-void Database::save_table(size_t table_pos, const char* path) const
+void Database::parse_table_directive(const Vector<String>& tokens, Table& table, TableAnalysis& analysis, size_t& column_pos)
 {
-    m_tables[table_pos].save_to(path);
+    if (tokens[0] == "@lsn")
+    {
+        if (tokens.size() != 2) throw exception("invalid journal position");
+        table.set_journal_lsn(convert_string_to_integer(tokens[1]));
+    }
+    else if (tokens[0] == "@index")
+    {
+        if (tokens.size() != 2) throw exception("invalid index");
+        size_t indexed_column_pos = table.find_column_by_name(tokens[1]);
+        if (indexed_column_pos == -1) throw exception("invalid index: column not found");
+        table.create_trigram_index(indexed_column_pos);
+    }
+    else if (tokens[0] == "@analysis")
+    {
+        if (tokens.size() != 3) throw exception("invalid analysis");
+        analysis = TableAnalysis(convert_string_to_integer(tokens[1]), convert_string_to_integer(tokens[2]), table.columns().size());
+        column_pos = -1;
+    }
+    else if (tokens[0] == "@column")
+    {
+        if (tokens.size() != 4 or analysis.is_empty()) throw exception("invalid analysis");
+        column_pos = table.find_column_by_name(tokens[1]);
+        if (column_pos == -1) throw exception("invalid analysis: column not found");
+        analysis.column(column_pos).set_null_fraction(convert_string_to_real(tokens[2]));
+        analysis.column(column_pos).set_histogram_fraction(convert_string_to_real(tokens[3]));
+    }
+    else if (tokens[0] == "@mcv")
+    {
+        if (tokens.size() != 3 or column_pos == -1) throw exception("invalid analysis");
+        Real frequency = convert_string_to_real(tokens[2]);
+        Cell* value = parse_value_token(tokens[1]);
+        if (value == nullptr) throw exception("invalid analysis: null value");
+        analysis.column(column_pos).add_most_common_value(value, frequency);
+    }
+    else if (tokens[0] == "@bound")
+    {
+        if (tokens.size() != 2 or column_pos == -1) throw exception("invalid analysis");
+        Cell* bound = parse_value_token(tokens[1]);
+        if (bound == nullptr) throw exception("invalid analysis: null value");
+        analysis.column(column_pos).add_histogram_bound(bound);
+    }
+    else
+    {
+        throw exception("invalid analysis directive");
+    }
 }
 
-const Vector<Table>& Database::tables() const
+void Database::replay_journal(const char* path)
 {
-    return m_tables;
+    ifstream ifs(path);
+    if (not ifs.is_open()) return;
+    char buffer[BUFFER_SIZE];
+
+    // a transaction whose '@commit' is missing was cut short by a crash, and is dropped with the lines read for it
+    // the journal is read in full before replaying it, as a table saved since a record may be named the way a later rename left it
+    LogSequenceNumber lsn = 0;
+    Vector<Vector<String>> records;
+    Vector<LogSequenceNumber> transaction_lsns;
+    Vector<Vector<Vector<String>>> transactions;
+    while (ifs.getline(buffer, BUFFER_SIZE, '\n'))
+    {
+        String line = buffer;
+        format(line);
+        Vector<String> tokens = move(tokenize(line));
+        combine_keyword_tokens(tokens);
+        if (tokens.is_empty()) continue;
+
+        if (buffer[0] == '@' and tokens[0] == "@begin" and tokens.size() == 2)
+        {
+            lsn = convert_string_to_integer(tokens[1]);
+            records.clear();
+        }
+        else if (buffer[0] == '@' and tokens[0] == "@commit" and tokens.size() == 2)
+        {
+            if (convert_string_to_integer(tokens[1]) != lsn)
+            {
+                cout << "error reading from journal: unmatched commit\n";
+                continue;
+            }
+            transaction_lsns.append(lsn);
+            transactions.append(move(records));
+            records.clear();
+        }
+        else
+        {
+            records.append(move(tokens));
+        }
+    }
+
+    Vector<JournalRename> renames;
+    for (size_t i = 0; i < transactions.size(); i += 1)
+    {
+        for (size_t j = 0; j < transactions[i].size(); j += 1)
+        {
+            const Vector<String>& record = transactions[i][j];
+            if (record[0] == "@insert" or record[0] == "@delete" or record[0] == "@create")
+            {
+                // the line after it holds values or column definitions
+                j += 1;
+            }
+            else if (record[0] == "@rename" and record.size() == 3)
+            {
+                renames.append(JournalRename{ transaction_lsns[i], record[1], record[2] });
+            }
+        }
+    }
+    for (size_t i = 0; i < transactions.size(); i += 1)
+    {
+        replay_journal_transaction(transaction_lsns[i], transactions[i], renames);
+        m_last_lsn = max(m_last_lsn, transaction_lsns[i]);
+    }
 }
 
-void Database::list_tables() const
+size_t Database::find_table_saved_since(const StringView& table_name, LogSequenceNumber lsn, const Vector<JournalRename>& renames) const
 {
-    if (m_tables.is_empty())
+    StringView renamed_table_name = table_name;
+    for (size_t i = 0; i < renames.size(); i += 1)
     {
-        cout << "Empty set\n";
-        return;
+        if (renames[i].lsn >= lsn and renames[i].old_name == renamed_table_name)
+        {
+            renamed_table_name = renames[i].new_name;
+        }
     }
 
-    size_t width = m_name.size();
-    for (size_t i = 0; i < m_tables.size(); i += 1)
+    size_t table_pos = find_table_by_name(table_name);
+    if (table_pos != -1 and m_tables[table_pos].journal_lsn() >= lsn) return table_pos;
+    table_pos = find_table_by_name(renamed_table_name);
+    if (table_pos != -1 and m_tables[table_pos].journal_lsn() >= lsn) return table_pos;
+    return -1;
+}
+
+// the number of tokens of each kind of journal record, 0 for an unknown one
+static size_t count_record_tokens(const StringView& kind)
+{
+    if (kind == "@insert" or kind == "@delete" or kind == "@truncate" or kind == "@create" or kind == "@drop") return 2;
+    if (kind == "@rename" or kind == "@drop_column") return 3;
+    if (kind == "@add_column" or kind == "@rename_column") return 4;
+    return 0;
+}
+
+void Database::replay_journal_transaction(LogSequenceNumber lsn, const Vector<Vector<String>>& records, const Vector<JournalRename>& renames)
+{
+    Snapshot snapshot = m_transactions.begin_write();
+    // where the last '@delete' found its row; a statement deletes rows in table order, and journals them so
+    size_t deleted_row_pos = 0;
+    for (size_t i = 0; i < records.size(); i += 1)
     {
-        width = max(width, m_tables[i].name().size());
+        const Vector<String>& record = records[i];
+        size_t token_count = count_record_tokens(record[0]);
+        if (token_count == 0)
+        {
+            cout << "error reading from journal: invalid record\n";
+            continue;
+        }
+        // '@insert' and '@delete' are followed by a line with the row's values, '@create' by one with the table's column definitions
+        bool has_row = record[0] == "@insert" or record[0] == "@delete";
+        if (has_row or record[0] == "@create")
+        {
+            i += 1;
+            if (i == records.size())
+            {
+                cout << "error reading from journal: missing " << (has_row ? "row" : "column definitions") << '\n';
+                break;
+            }
+        }
+
+        if (record.size() != token_count)
+        {
+            cout << "error reading from journal: invalid record\n";
+            continue;
+        }
+        // already in the file the table was read from, perhaps under the name a later rename gave it
+        if (find_table_saved_since(record[1], lsn, renames) != -1) continue;
+
+        size_t table_pos = find_table_by_name(record[1]);
+        if (record[0] == "@create")
+        {
+            if (table_pos != -1)
+            {
+                cout << "error reading from journal: table already exists\n";
+                continue;
+            }
+
+            Vector<Column> columns;
+            try { columns = move(parse_column_definitions_clause(records[i])); }
+            catch (const exception& e)
+            {
+                cout << "error reading from journal: " << e.what() << '\n';
+                continue;
+            }
+            m_tables.append(Table(record[1], move(columns)));
+            m_table_names.append(m_tables.back().name());
+            continue;
+        }
+        if (table_pos == -1)
+        {
+            cout << "error reading from journal: table not found\n";
+            continue;
+        }
+        Table& table = m_tables[table_pos];
+
+        if (record[0] == "@truncate")
+        {
+            table.truncate();
+            continue;
+        }
+        if (record[0] == "@drop")
+        {
+            m_tables.erase(table_pos);
+            m_table_names.erase(table_pos);
+            continue;
+        }
+        if (record[0] == "@rename")
+        {
+            table.rename_to(record[2]);
+            m_table_names.rename(table_pos, table.name());
+            continue;
+        }
+        if (record[0] == "@add_column" or record[0] == "@drop_column" or record[0] == "@rename_column")
+        {
+            try
+            {
+                if (record[0] == "@add_column")
+                {
+                    DataType data_type = convert_string_to_data_type(record[3]);
+                    if (data_type == DataType::INVALID) throw exception("invalid data type");
+                    table.add_column(Column(record[2], data_type));
+                }
+                else if (record[0] == "@drop_column")
+                {
+                    table.drop_column(table.find_column_by_name(record[2]));
+                }
+                else
+                {
+                    table.rename_column(table.find_column_by_name(record[2]), record[3]);
+                }
+            }
+            catch (const exception& e) { cout << "error reading from journal: " << e.what() << '\n'; }
+            continue;
+        }
+
+        Vector<Cell*> row;
+        try { row = move(parse_row(records[i])); }
+        catch (const exception& e)
+        {
+            Table::free_row(row);
+            cout << "error reading from journal: " << e.what() << '\n';
+            continue;
+        }
+        if (record[0] == "@insert")
+        {
+            try { table.insert(move(row), snapshot.own); }
+            catch (const exception& e)
+            {
+                Table::free_row(row);
+                cout << "error reading from journal: " << e.what() << '\n';
+            }
+        }
+        else
+        {
+            if (not table.delete_row_equal_to(row, snapshot, deleted_row_pos))
+            {
+                cout << "error reading from journal: deleted row not found\n";
+            }
+            Table::free_row(row);
+        }
     }
+    m_transactions.finish_write(snapshot);
+}
 
-    // +-...-+
-    cout << "+-";
-    for (size_t i = 0; i < width; i += 1)
+void Database::journal_table_creation(const Table& table)
+{
+    ostringstream records;
+    records << "@create " << table.name() << '\n';
+    table.write_column_definitions_to(records);
+    if (not write_to_journal(records.str())) throw exception("could not write the journal");
+}
+
+bool Database::write_to_journal(const string& records)
+{
+    if (m_journal == nullptr or records.empty()) return true;
+
+    LogSequenceNumber lsn = m_last_lsn + 1;
+    ostringstream framed_records;
+    framed_records << "@begin " << lsn << '\n' << records << "@commit " << lsn << '\n';
+    string text = framed_records.str();
+    if (fwrite(text.data(), 1, text.size(), m_journal) != text.size() or not sync_to_disk(m_journal)) return false;
+
+    m_last_lsn = lsn;
+    return true;
+}
+
+Transaction Database::begin_transaction()
+{
+    return Transaction(m_transactions.begin_write(true));
+}
+
+void Database::commit_transaction(Transaction& transaction)
+{
+    ostringstream records;
     {
-        cout << "-";
+        SnapshotGuard guard(*this, transaction.changed_table_positions());
+        for (size_t i = 0; i < transaction.undo_log.size(); i += 1)
+        {
+            const UndoRecord& record = transaction.undo_log[i];
+            const Table& table = m_tables[record.table_pos];
+            size_t row_pos = table.find_row_by_id(record.change.row_id);
+            if (row_pos == -1) continue;
+
+            // a version the transaction both created and deleted was never seen by anyone else
+            const RowVersion& version = table.version(row_pos);
+            if (version.created_by == transaction.snapshot.own and version.deleted_by.load() == transaction.snapshot.own) continue;
+
+            records << (record.change.kind == RowChange::Kind::CREATED ? "@insert " : "@delete ") << table.name() << '\n';
+            table.write_row_to(records, row_pos);
+        }
     }
-    cout << "-";
-    cout << "+\n";
 
-    // | ... |
-    cout << "| ";
-    cout << m_name;
-    for (size_t i = 0; i < width - m_name.size(); i += 1)
+    if (not write_to_journal(records.str()))
     {
-        cout << " ";
+        roll_back_transaction(transaction);
+        throw exception("could not write the journal");
     }
-    cout << " ";
-    cout << "|\n";
+    transaction.undo_log.clear();
+    m_transactions.finish_write(transaction.snapshot);
+}
 
-    // +-...-+
-    cout << "+-";
-    for (size_t i = 0; i < width; i += 1)
+void Database::roll_back_transaction(Transaction& transaction)
+{
     {
-        cout << "-";
+        SnapshotGuard guard(*this, transaction.changed_table_positions());
+        // newest first, so that a version updated twice ends up as it was at the start
+        for (size_t i = transaction.undo_log.size(); i > 0; i -= 1)
+        {
+            const UndoRecord& record = transaction.undo_log[i - 1];
+            m_tables[record.table_pos].undo(record.change, transaction.snapshot.own);
+        }
     }
-    cout << "-";
-    cout << "+\n";
+    transaction.undo_log.clear();
+    m_transactions.finish_write(transaction.snapshot);
+}
 
-    if (m_tables.is_empty()) return;
-    // | ... |
-    for (size_t i = 0; i < m_tables.size(); i += 1)
+void Database::run_statement(WriteGuard& guard, Vector<RowChange>& changes, const Function<void, const Snapshot&>& statement)
+{
+    Transaction& transaction = guard.transaction();
+    try { statement(transaction.snapshot); }
+    catch (const exception&)
     {
-        cout << "| ";
-        cout << m_tables[i].name();
-        for (size_t k = 0; k < width - m_tables[i].name().size(); k += 1)
+        for (size_t i = changes.size(); i > 0; i -= 1)
         {
-            cout << " ";
+            m_tables[guard.table_pos()].undo(changes[i - 1], transaction.snapshot.own);
         }
-        cout << " ";
-        cout << "|\n";
+        throw;
     }
+    transaction.log(guard.table_pos(), changes);
+}
+
+void Database::vacuum_table(const StringView& table_name)
+{
+    SchemaChangeGuard guard(*this, table_name);
+    m_tables[guard.table_pos()].vacuum(guard.snapshot().horizon);
+}
 
-    // +-...-+
-    cout << "+-";
-    for (size_t i = 0; i < width; i += 1)
+void Database::analyze_table(const StringView& table_name)
+{
+    shared_lock<Latch> catalog_lock = latch_catalog();
+    size_t table_pos = find_table_by_name(table_name);
+    if (table_pos == -1) throw exception("table not found");
+    SnapshotGuard guard(*this, move(catalog_lock), { table_pos });
+    m_tables[table_pos].analyze(guard.snapshot());
+}
+
+void Database::create_index_on_table(const StringView& table_name, const StringView& column_name)
+{
+    SchemaChangeGuard guard(*this, table_name, "table not found");
+    Table& table = m_tables[guard.table_pos()];
+    size_t column_pos = table.find_column_by_name(column_name);
+    if (column_pos == -1) throw exception("column not found");
+    table.create_trigram_index(column_pos);
+}
+void Database::drop_index_from_table(const StringView& table_name, const StringView& column_name)
+{
+    SchemaChangeGuard guard(*this, table_name, "table not found");
+    Table& table = m_tables[guard.table_pos()];
+    size_t column_pos = table.find_column_by_name(column_name);
+    if (column_pos == -1) throw exception("column not found");
+    table.drop_trigram_index(column_pos);
+}
+
+void Database::save_table(const StringView& table_name, const char* path)
+{
+    // with the writer kept out, the rows saved are exactly those of the transactions journaled so far
+    Snapshot writer_snapshot = m_transactions.begin_write();
+    try
+    {
+        shared_lock<Latch> catalog_lock = latch_catalog();
+        size_t table_pos = find_table_by_name(table_name);
+        if (table_pos == -1) throw exception("table pos out of bounds");
+        SnapshotGuard guard(*this, move(catalog_lock), { table_pos });
+        m_tables[table_pos].save_to(path, guard.snapshot(), m_last_lsn);
+    }
+    catch (const exception&)
     {
-        cout << "-";
+        m_transactions.finish_write(writer_snapshot);
+        throw;
     }
-    cout << "-";
-    cout << "+\n";
+    m_transactions.finish_write(writer_snapshot);
 }
 
-size_t Database::find_table_by_name(const StringView& table_name) const
+const Vector<Table>& Database::tables() const
+{
+    return m_tables;
+}
+
+const String& Database::name() const
 {
-    for (size_t i = 0; i < tables().size(); i += 1)
+    return m_name;
+}
+
+Vector<String> Database::list_tables() const
+{
+    shared_lock<Latch> catalog_lock(m_catalog_latch);
+    Vector<String> table_names;
+    table_names.resize_capacity_to(m_tables.size());
+    for (size_t i = 0; i < m_tables.size(); i += 1)
     {
-        if (tables()[i].name() == table_name)
-        {
-            return i;
-        }
+        table_names.append(m_tables[i].name());
     }
-    return -1;
+    return table_names;
+}
+
+size_t Database::find_table_by_name(const StringView& table_name) const
+{
+    return m_table_names.find(table_name);
+}
+shared_lock<Latch> Database::latch_catalog() const
+{
+    return shared_lock<Latch>(m_catalog_latch);
 }
 
 void Database::create_table(const StringView& table_name, const Vector<Column>& columns)
 {
-    m_tables.append(Table(table_name, columns));
+    SchemaChangeGuard guard(*this);
+    Table table(table_name, columns);
+    journal_table_creation(table);
+    m_tables.append(move(table));
+    m_table_names.append(m_tables.back().name());
 }
 void Database::create_table(const StringView& table_name, Vector<Column>&& columns)
 {
-    m_tables.append(Table(table_name, move(columns)));
+    SchemaChangeGuard guard(*this);
+    Table table(table_name, move(columns));
+    journal_table_creation(table);
+    m_tables.append(move(table));
+    m_table_names.append(m_tables.back().name());
 }
 void Database::create_table(String&& table_name, const Vector<Column>& columns)
 {
-    m_tables.append(Table(move(table_name), columns));
+    SchemaChangeGuard guard(*this);
+    Table table(move(table_name), columns);
+    journal_table_creation(table);
+    m_tables.append(move(table));
+    m_table_names.append(m_tables.back().name());
 }
 void Database::create_table(String&& table_name, Vector<Column>&& columns)
 {
-    m_tables.append(Table(move(table_name), move(columns)));
+    SchemaChangeGuard guard(*this);
+    Table table(move(table_name), move(columns));
+    journal_table_creation(table);
+    m_tables.append(move(table));
+    m_table_names.append(m_tables.back().name());
 }
 
-void Database::drop_table(size_t table_pos)
+void Database::drop_table(const StringView& table_name)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
+    SchemaChangeGuard guard(*this);
+    size_t table_pos = find_table_by_name(table_name);
+    if (table_pos == -1) throw exception("table pos out of bounds");
+
+    ostringstream records;
+    records << "@drop " << table_name << '\n';
+    if (not write_to_journal(records.str())) throw exception("could not write the journal");
     m_tables.erase(table_pos);
+    m_table_names.erase(table_pos);
 }
 
-void Database::rename_table(size_t table_pos, const StringView& new_table_name)
+void Database::rename_table(const StringView& table_name, const StringView& new_table_name)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
+    SchemaChangeGuard guard(*this);
+    size_t table_pos = find_table_by_name(table_name);
+    if (table_pos == -1) throw exception("table pos out of bounds");
+
+    ostringstream records;
+    records << "@rename " << table_name << ' ' << new_table_name << '\n';
+    if (not write_to_journal(records.str())) throw exception("could not write the journal");
     m_tables[table_pos].rename_to(new_table_name);
+    m_table_names.rename(table_pos, m_tables[table_pos].name());
 }
-void Database::rename_table(size_t table_pos, String&& new_table_name)
+void Database::rename_table(const StringView& table_name, String&& new_table_name)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
+    SchemaChangeGuard guard(*this);
+    size_t table_pos = find_table_by_name(table_name);
+    if (table_pos == -1) throw exception("table pos out of bounds");
+
+    ostringstream records;
+    records << "@rename " << table_name << ' ' << new_table_name << '\n';
+    if (not write_to_journal(records.str())) throw exception("could not write the journal");
     m_tables[table_pos].rename_to(move(new_table_name));
+    m_table_names.rename(table_pos, m_tables[table_pos].name());
 }
 
-void Database::add_column_to_table(size_t table_pos, const Column& column)
+void Database::add_column_to_table(const StringView& table_name, const Column& column)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
-    m_tables[table_pos].add_column(column);
+    SchemaChangeGuard guard(*this, table_name);
+    Table& table = m_tables[guard.table_pos()];
+
+    ostringstream records;
+    records << "@add_column " << table.name() << ' ' << column.name() << ' ' << convert_data_type_to_string(column.data_type()) << '\n';
+    if (not write_to_journal(records.str())) throw exception("could not write the journal");
+    table.add_column(column);
 }
-void Database::add_column_to_table(size_t table_pos, Column&& column)
+void Database::add_column_to_table(const StringView& table_name, Column&& column)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
-    m_tables[table_pos].add_column(move(column));
+    SchemaChangeGuard guard(*this, table_name);
+    Table& table = m_tables[guard.table_pos()];
+
+    ostringstream records;
+    records << "@add_column " << table.name() << ' ' << column.name() << ' ' << convert_data_type_to_string(column.data_type()) << '\n';
+    if (not write_to_journal(records.str())) throw exception("could not write the journal");
+    table.add_column(move(column));
 }
 
-void Database::drop_column_from_table(size_t table_pos, size_t column_pos)
+void Database::drop_column_from_table(const StringView& table_name, const StringView& column_name)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
-    try { m_tables[table_pos].drop_column(column_pos); }
-    catch (const exception& e) { throw e; }
+    SchemaChangeGuard guard(*this, table_name);
+    Table& table = m_tables[guard.table_pos()];
+    size_t column_pos = table.find_column_by_name(column_name);
+    if (column_pos == -1) throw exception("column pos out of bounds");
+
+    ostringstream records;
+    records << "@drop_column " << table.name() << ' ' << column_name << '\n';
+    if (not write_to_journal(records.str())) throw exception("could not write the journal");
+    table.drop_column(column_pos);
 }
 
-void Database::rename_column_from_table(size_t table_pos, size_t column_pos, const StringView& new_column_name)
+void Database::rename_column_from_table(const StringView& table_name, const StringView& column_name, const StringView& new_column_name)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
-    try { m_tables[table_pos].rename_column(column_pos, new_column_name); }
-    catch (const exception& e) { throw e; }
+    SchemaChangeGuard guard(*this, table_name);
+    Table& table = m_tables[guard.table_pos()];
+    size_t column_pos = table.find_column_by_name(column_name);
+    if (column_pos == -1) throw exception("column pos out of bounds");
+
+    ostringstream records;
+    records << "@rename_column " << table.name() << ' ' << column_name << ' ' << new_column_name << '\n';
+    if (not write_to_journal(records.str())) throw exception("could not write the journal");
+    table.rename_column(column_pos, new_column_name);
 }
-void Database::rename_column_from_table(size_t table_pos, size_t column_pos, String&& new_column_name)
+void Database::rename_column_from_table(const StringView& table_name, const StringView& column_name, String&& new_column_name)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
-    try { m_tables[table_pos].rename_column(column_pos, move(new_column_name)); }
-    catch (const exception& e) { throw e; }
+    SchemaChangeGuard guard(*this, table_name);
+    Table& table = m_tables[guard.table_pos()];
+    size_t column_pos = table.find_column_by_name(column_name);
+    if (column_pos == -1) throw exception("column pos out of bounds");
+
+    ostringstream records;
+    records << "@rename_column " << table.name() << ' ' << column_name << ' ' << new_column_name << '\n';
+    if (not write_to_journal(records.str())) throw exception("could not write the journal");
+    table.rename_column(column_pos, move(new_column_name));
 }
 
-void Database::insert_into_table(size_t table_pos, const Vector<Cell*>& row)
+void Database::insert_into_table(WriteGuard& guard, const Vector<Cell*>& row)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
-    try { m_tables[table_pos].insert(row); }
-    catch (const exception& e) { throw e; }
+    Vector<RowChange> changes;
+    run_statement(guard, changes, [&](const Snapshot& snapshot) -> void
+    {
+        changes.append(RowChange{ RowChange::Kind::CREATED, m_tables[guard.table_pos()].insert(row, snapshot.own) });
+    });
 }
-void Database::insert_into_table(size_t table_pos, Vector<Cell*>&& row)
+void Database::insert_into_table(WriteGuard& guard, Vector<Cell*>&& row)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
-    try { m_tables[table_pos].insert(move(row)); }
-    catch (const exception& e) { throw e; }
+    Vector<RowChange> changes;
+    run_statement(guard, changes, [&](const Snapshot& snapshot) -> void
+    {
+        changes.append(RowChange{ RowChange::Kind::CREATED, m_tables[guard.table_pos()].insert(move(row), snapshot.own) });
+    });
 }
 
-void Database::update_table(size_t table_pos, size_t column_pos, const Cell* value, const Function<bool, Vector<Cell*>>& condition)
+void Database::update_table(WriteGuard& guard, size_t column_pos, const Cell* value, const Function<bool, Vector<Cell*>>& condition)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
-    try { m_tables[table_pos].update_if(column_pos, value, condition); }
-    catch (const exception& e) { throw e; }
+    Vector<RowChange> changes;
+    run_statement(guard, changes, [&](const Snapshot& snapshot) -> void
+    {
+        m_tables[guard.table_pos()].update_if(column_pos, value, condition, snapshot, changes);
+    });
 }
 
-void Database::truncate_table(size_t table_pos)
+void Database::truncate_table(const StringView& table_name)
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
+    // not versioned: the rows are gone for every snapshot at once
+    SchemaChangeGuard guard(*this, table_name);
+    Table& table = m_tables[guard.table_pos()];
+
+    ostringstream records;
+    records << "@truncate " << table.name() << '\n';
+    if (not write_to_journal(records.str())) throw exception("could not write the journal");
+    table.truncate();
+}
 
-    m_tables[table_pos].truncate();
+void Database::delete_from_table(WriteGuard& guard, const Function<bool, Vector<Cell*>>& condition)
+{
+    Vector<RowChange> changes;
+    run_statement(guard, changes, [&](const Snapshot& snapshot) -> void
+    {
+        m_tables[guard.table_pos()].delete_rows_if(condition, snapshot, changes);
+    });
 }
 
-void Database::delete_from_table(size_t table_pos, const Function<bool, Vector<Cell*>>& condition)
+/* SnapshotGuard */
+
+SnapshotGuard::SnapshotGuard(const Database& database, const Vector<size_t>& table_positions, const Transaction* transaction) :
+    SnapshotGuard(database, database.latch_catalog(), table_positions, transaction) {}
+SnapshotGuard::SnapshotGuard(const Database& database, shared_lock<Latch>&& catalog_lock, const Vector<size_t>& table_positions, const Transaction* transaction) :
+    m_database(database), m_catalog_lock(move(catalog_lock)), m_table_positions(table_positions), m_snapshot()
+{
+    sort(m_table_positions.data(), m_table_positions.data() + m_table_positions.size());
+    size_t unique_count = unique(m_table_positions.data(), m_table_positions.data() + m_table_positions.size()) - m_table_positions.data();
+    m_table_positions.resize_to(unique_count);
+    for (size_t i = 0; i < m_table_positions.size(); i += 1)
+    {
+        m_database.m_tables[m_table_positions[i]].latch().lock_shared();
+    }
+    // taken only once the tables are latched, since until then a purge may remove versions an earlier snapshot would see
+    m_snapshot = transaction == nullptr ? m_database.m_transactions.take_snapshot() : transaction->snapshot;
+}
+SnapshotGuard::SnapshotGuard(SnapshotGuard&& other) noexcept : m_database(other.m_database), m_catalog_lock(move(other.m_catalog_lock)),
+    m_table_positions(move(other.m_table_positions)), m_snapshot(other.m_snapshot) {}
+SnapshotGuard::~SnapshotGuard() noexcept
 {
-    if (m_tables.is_empty() or table_pos > m_tables.size() - 1) throw exception("table pos out of bounds");
-    m_tables[table_pos].delete_rows_if(condition);
+    for (size_t i = m_table_positions.size(); i > 0; i -= 1)
+    {
+        m_database.m_tables[m_table_positions[i - 1]].latch().unlock_shared();
+    }
+}
+
+const Snapshot& SnapshotGuard::snapshot() const
+{
+    return m_snapshot;
+}
+
+/* WriteGuard */
+
+WriteGuard::WriteGuard(Database& database, Transaction* transaction, const StringView& table_name) : m_database(database), m_has_own_transaction(transaction == nullptr),
+    m_own_transaction(m_has_own_transaction ? database.m_transactions.begin_write() : Snapshot{}), m_transaction(m_has_own_transaction ? &m_own_transaction : transaction),
+    m_catalog_lock(database.m_catalog_latch), m_table_lock(), m_table_pos(database.find_table_by_name(table_name))
+{
+    if (m_table_pos == -1)
+    {
+        release();
+        throw exception("table pos out of bounds");
+    }
+    m_table_lock = shared_lock<Latch>(m_database.m_tables[m_table_pos].latch());
+}
+WriteGuard::~WriteGuard() noexcept
+{
+    release();
+}
+
+void WriteGuard::release() noexcept
+{
+    if (m_table_lock.owns_lock())
+    {
+        m_table_lock.unlock();
+    }
+    if (m_catalog_lock.owns_lock())
+    {
+        m_catalog_lock.unlock();
+    }
+    if (m_has_own_transaction)
+    {
+        m_has_own_transaction = false;
+        m_database.roll_back_transaction(m_own_transaction);
+    }
+}
+
+size_t WriteGuard::table_pos() const
+{
+    return m_table_pos;
+}
+
+Transaction& WriteGuard::transaction()
+{
+    return *m_transaction;
+}
+
+void WriteGuard::commit()
+{
+    // the writer's right is still held, so no schema change moves the table before the commit latches it again
+    m_table_lock.unlock();
+    m_catalog_lock.unlock();
+    if (m_has_own_transaction)
+    {
+        m_has_own_transaction = false;
+        m_database.commit_transaction(m_own_transaction);
+    }
 }
\ No newline at end of file
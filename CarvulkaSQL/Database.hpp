@@ -1,51 +1,208 @@
 #pragma once
 
 #include "Table.hpp"
+#include "Latch.hpp"
+#include "NameIndex.hpp"
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// a change to undo, and the table it was made in
+struct UndoRecord
+{
+    size_t table_pos;
+    RowChange change;
+};
+
+// from BEGIN to COMMIT or ROLLBACK; it holds the writer's right the whole time, and reads through the snapshot taken at BEGIN
+struct Transaction
+{
+    Snapshot snapshot;
+    Vector<UndoRecord> undo_log;
 
+    Transaction(const Snapshot& snapshot);
+
+    void log(size_t table_pos, const Vector<RowChange>& changes);
+    // the tables the transaction changed rows of, each once
+    Vector<size_t> changed_table_positions() const;
+};
+
+// a table renamed in the journal; the records before the rename name it the way it was called then
+struct JournalRename
+{
+    LogSequenceNumber lsn;
+    String old_name;
+    String new_name;
+};
+
+class WriteGuard;
+
+// statements reading or writing rows hold the latches of their tables shared, so they run side by side: readers see the snapshot
+// they started with and the one writer at a time adds versions next to them; changes to a table's layout and purges, which move
+// its rows, hold its latch exclusively; every statement holds the catalog latch shared, adding or removing tables holds it exclusively
+// the catalog is always latched before tables, and tables in ascending position, so no two statements wait on each other
+// a statement looks its tables and columns up by name only with them latched, so that a schema change can't move them before it ran
+// committed changes and schema changes go to the journal next to the database file, which is replayed over the saved tables at startup;
+// a schema change is journaled before it is applied, so one the journal could not take leaves the catalog as it was
 class Database
 {
+    friend class SchemaChangeGuard;
+    friend class SnapshotGuard;
+    friend class WriteGuard;
 public:
     static constexpr size_t BUFFER_SIZE = 256;
+    static constexpr std::chrono::milliseconds PURGE_INTERVAL = std::chrono::milliseconds(1000);
 private:
     String m_name;
     Vector<Table> m_tables;
+    // the names of m_tables, changed along with them
+    NameIndex m_table_names;
+    mutable Latch m_catalog_latch;
+    TransactionManager m_transactions;
+    // purges the versions no snapshot can see any more every PURGE_INTERVAL, skipping a round while statements run
+    std::thread m_purge_thread;
+    std::mutex m_purge_mutex;
+    std::condition_variable m_purge_condition;
+    bool m_is_closing;
+    // nullptr if the database was not read from a file, its changes then only live in memory
+    FILE* m_journal;
+    LogSequenceNumber m_last_lsn;
+private:
+    void run_purge_loop();
+    void try_purge();
+    // reads one '@' line written after a table's rows by Table::save_to
+    static void parse_table_directive(const Vector<String>& tokens, Table& table, TableAnalysis& analysis, size_t& column_pos);
+
+    // applies the transactions that made it to the journal in full, skipping the ones a table was saved with
+    void replay_journal(const char* path);
+    void replay_journal_transaction(LogSequenceNumber lsn, const Vector<Vector<String>>& records, const Vector<JournalRename>& renames);
+    // the table read from a file saved since the transaction @lsn, under @table_name or the name the renames after it gave the table;
+    // -1 if there is none, and the transaction's records for the table are still to be replayed
+    size_t find_table_saved_since(const StringView& table_name, LogSequenceNumber lsn, const Vector<JournalRename>& renames) const;
+    // appends @records framed by '@begin' and '@commit' and syncs the file once; the caller holds the writer's right
+    // returns false if the records could not be made durable
+    bool write_to_journal(const std::string& records);
+    // like every schema change, a table created is journaled, so that the rows journaled for it find it at startup; throws if that fails
+    void journal_table_creation(const Table& table);
+
+    // runs one statement in the transaction of @guard; @statement appends the changes it makes to @changes, and a failed statement
+    // undoes them, leaving the transaction as it was before it
+    void run_statement(WriteGuard& guard, Vector<RowChange>& changes, const Function<void, const Snapshot&>& statement);
 public:
     Database(const char* path);
 
-    void load_database_from(const char* path);
+    Database(const Database& other) = delete;
+    ~Database() noexcept;
+    Database& operator = (const Database& other) = delete;
+
+    // returns false if there is no database at @path
+    bool load_database_from(const char* path);
     void load_table_from(const char* path);
-    void save_table(size_t table_pos, const char* path) const;
+    void save_table(const StringView& table_name, const char* path);
 
     const Vector<Table>& tables() const;
 
-    void list_tables() const;
+    const String& name() const;
+    Vector<String> list_tables() const;
 
+    // the caller holds the catalog latch, see latch_catalog
     size_t find_table_by_name(const StringView& table_name) const;
+    // for a statement to look up the tables it reads before latching them; SnapshotGuard takes the lock over
+    std::shared_lock<Latch> latch_catalog() const;
 
     void create_table(const StringView& table_name, const Vector<Column>& columns);
     void create_table(const StringView& table_name, Vector<Column>&& columns);
     void create_table(String&& table_name, const Vector<Column>& columns);
     void create_table(String&& table_name, Vector<Column>&& columns);
 
-    void drop_table(size_t table_pos);
+    // schema changes look the table up once they have it latched
+    void drop_table(const StringView& table_name);
+
+    void rename_table(const StringView& table_name, const StringView& new_table_name);
+    void rename_table(const StringView& table_name, String&& new_table_name);
+
+    void add_column_to_table(const StringView& table_name, const Column& column);
+    void add_column_to_table(const StringView& table_name, Column&& column);
+
+    void drop_column_from_table(const StringView& table_name, const StringView& column_name);
 
-    void rename_table(size_t table_pos, const StringView& new_table_name);
-    void rename_table(size_t table_pos, String&& new_table_name);
+    void rename_column_from_table(const StringView& table_name, const StringView& column_name, const StringView& new_column_name);
+    void rename_column_from_table(const StringView& table_name, const StringView& column_name, String&& new_column_name);
 
-    void add_column_to_table(size_t table_pos, const Column& column);
-    void add_column_to_table(size_t table_pos, Column&& column);
+    // for a transaction left open between statements; throws if another one is, see TransactionManager::begin_write
+    Transaction begin_transaction();
+    // writes the transaction's changes to the journal as one record and finishes it; rolls it back if that fails
+    void commit_transaction(Transaction& transaction);
+    void roll_back_transaction(Transaction& transaction);
 
-    void drop_column_from_table(size_t table_pos, size_t column_pos);
+    // change the table latched by @guard, in its transaction
+    void insert_into_table(WriteGuard& guard, const Vector<Cell*>& row);
+    void insert_into_table(WriteGuard& guard, Vector<Cell*>&& row);
 
-    void rename_column_from_table(size_t table_pos, size_t column_pos, const StringView& new_column_name);
-    void rename_column_from_table(size_t table_pos, size_t column_pos, String&& new_column_name);
+    void update_table(WriteGuard& guard, size_t column_pos, const Cell* value, const Function<bool, Vector<Cell*>>& condition);
 
-    void insert_into_table(size_t table_pos, const Vector<Cell*>& row);
-    void insert_into_table(size_t table_pos, Vector<Cell*>&& row);
+    void truncate_table(const StringView& table_name);
 
-    void update_table(size_t table_pos, size_t column_pos, const Cell* value, const Function<bool, Vector<Cell*>>& condition);
+    void delete_from_table(WriteGuard& guard, const Function<bool, Vector<Cell*>>& condition);
+
+    void vacuum_table(const StringView& table_name);
+    void analyze_table(const StringView& table_name);
+
+    void create_index_on_table(const StringView& table_name, const StringView& column_name);
+    void drop_index_from_table(const StringView& table_name, const StringView& column_name);
+};
+
+// fixes the snapshot a statement reads through and keeps the rows of the tables it reads in place until it goes out of scope
+class SnapshotGuard
+{
+private:
+    const Database& m_database;
+    std::shared_lock<Latch> m_catalog_lock;
+    Vector<size_t> m_table_positions; // ascending
+    Snapshot m_snapshot;
+public:
+    // inside a @transaction, the statement reads through the transaction's snapshot and sees its changes
+    SnapshotGuard(const Database& database, const Vector<size_t>& table_positions, const Transaction* transaction = nullptr);
+    // for tables looked up while holding @catalog_lock, from Database::latch_catalog
+    SnapshotGuard(const Database& database, std::shared_lock<Latch>&& catalog_lock, const Vector<size_t>& table_positions, const Transaction* transaction = nullptr);
+
+    SnapshotGuard(const SnapshotGuard& other) = delete;
+    // for a cursor to hold on to a statement's snapshot after the statement returned
+    SnapshotGuard(SnapshotGuard&& other) noexcept;
+    ~SnapshotGuard() noexcept;
+    SnapshotGuard& operator = (const SnapshotGuard& other) = delete;
+
+    const Snapshot& snapshot() const;
+};
+
+// keeps the table a statement changes latched from looking it and its columns up until the statement ran; outside a transaction
+// the statement runs in one of its own, begun before anything is latched like every writer's, and undone unless committed
+class WriteGuard
+{
+private:
+    Database& m_database;
+    // the statement's own transaction, if it isn't part of one
+    bool m_has_own_transaction;
+    Transaction m_own_transaction;
+    Transaction* m_transaction;
+    std::shared_lock<Latch> m_catalog_lock;
+    std::shared_lock<Latch> m_table_lock;
+    size_t m_table_pos;
+private:
+    // unlatches, and undoes the statement's own transaction
+    void release() noexcept;
+public:
+    // throws if there is no table named @table_name, or if the statement would wait for a transaction left open
+    WriteGuard(Database& database, Transaction* transaction, const StringView& table_name);
 
-    void truncate_table(size_t table_pos);
+    WriteGuard(const WriteGuard& other) = delete;
+    ~WriteGuard() noexcept;
+    WriteGuard& operator = (const WriteGuard& other) = delete;
 
-    void delete_from_table(size_t table_pos, const Function<bool, Vector<Cell*>>& condition);
+    size_t table_pos() const;
+    Transaction& transaction();
+    // unlatches and commits the statement's own transaction; inside a transaction the changes wait for its COMMIT
+    void commit();
 };
\ No newline at end of file
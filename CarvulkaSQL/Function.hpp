@@ -1,74 +1,109 @@
 #pragma once
 
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// a callable taking a const Arg& and returning R, whatever its type; a callable of up to BUFFER_SIZE bytes is kept inline, a larger one on the heap
+// move-only: a function is handed on rather than copied, so that a condition built out of others takes them over instead of cloning each of them
 template<typename R, typename Arg>
 class Function
 {
+public:
+    static constexpr size_t BUFFER_SIZE = 4 * sizeof(void*);
 private:
-    struct Callable
+    // what is done with the callable depends on its type, which only the constructor knows; it leaves the functions for it here
+    struct Operations
     {
-        virtual ~Callable() = default;
-        virtual R operator()(Arg arg) const = 0;
-        virtual Callable* clone() const = 0;
+        R (*invoke)(const void* callable, const Arg& arg);
+        // moves the callable from @src to the uninitialized @dst, destroying the one at @src
+        void (*relocate)(void* dst, void* src);
+        void (*destroy)(void* callable);
     };
 
     template<typename F>
-    struct CallableImpl : public Callable
-    {
-        F function;
-
-        CallableImpl(const F& function) : function(function) {}
+    static constexpr bool is_kept_inline = sizeof(F) <= BUFFER_SIZE and alignof(F) <= alignof(std::max_align_t) and std::is_nothrow_move_constructible_v<F>;
 
-        R operator()(Arg arg) const override
-        {
-            return function(arg);
-        }
-
-        Callable* clone() const override
+    template<typename F>
+    static constexpr Operations inline_operations =
+    {
+        [](const void* callable, const Arg& arg) -> R { return (*static_cast<const F*>(callable))(arg); },
+        [](void* dst, void* src) -> void
         {
-            return new CallableImpl<F>(function);
-        }
+            new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        },
+        [](void* callable) -> void { static_cast<F*>(callable)->~F(); }
     };
-
-    Callable* callable;
-public:
+    // the buffer holds a pointer to the callable
     template<typename F>
-    Function(const F& function) : callable(new CallableImpl<F>(function)) {}
-
-    Function(const Function<R, Arg>& other) : callable(other.callable->clone()) {}
+    static constexpr Operations heap_operations =
+    {
+        [](const void* callable, const Arg& arg) -> R { return (**static_cast<F* const*>(callable))(arg); },
+        [](void* dst, void* src) -> void { *static_cast<F**>(dst) = *static_cast<F**>(src); },
+        [](void* callable) -> void { delete *static_cast<F**>(callable); }
+    };
 
-    Function(Function<R, Arg>&& other) noexcept : callable(other.callable)
+    alignas(std::max_align_t) unsigned char m_buffer[BUFFER_SIZE];
+    // nullptr once moved from
+    const Operations* m_operations;
+private:
+    void free()
     {
-        other.callable = nullptr;
+        if (m_operations != nullptr)
+        {
+            m_operations->destroy(m_buffer);
+        }
     }
-
-    ~Function()
+public:
+    template<typename F> requires (not std::is_same_v<std::remove_cvref_t<F>, Function<R, Arg>>)
+    Function(F&& function)
     {
-        delete callable;
+        using callable_type = std::remove_cvref_t<F>;
+        if constexpr (is_kept_inline<callable_type>)
+        {
+            new (m_buffer) callable_type(std::forward<F>(function));
+            m_operations = &inline_operations<callable_type>;
+        }
+        else
+        {
+            *reinterpret_cast<callable_type**>(m_buffer) = new callable_type(std::forward<F>(function));
+            m_operations = &heap_operations<callable_type>;
+        }
     }
 
-    Function<R, Arg>& operator = (const Function<R, Arg>& other)
+    Function(const Function<R, Arg>& other) = delete;
+    Function(Function<R, Arg>&& other) noexcept : m_operations(other.m_operations)
     {
-        if (this != &other)
+        if (m_operations != nullptr)
         {
-            delete callable;
-            callable = other.callable->clone();
+            m_operations->relocate(m_buffer, other.m_buffer);
+            other.m_operations = nullptr;
         }
-        return *this;
     }
-
+    ~Function() noexcept
+    {
+        free();
+    }
+    Function<R, Arg>& operator = (const Function<R, Arg>& other) = delete;
     Function<R, Arg>& operator = (Function<R, Arg>&& other) noexcept
     {
         if (this != &other)
         {
-            delete callable;
-            callable = other.callable;
-            other.callable = nullptr;
+            free();
+            m_operations = other.m_operations;
+            if (m_operations != nullptr)
+            {
+                m_operations->relocate(m_buffer, other.m_buffer);
+                other.m_operations = nullptr;
+            }
         }
         return *this;
     }
 
-    R operator()(Arg arg) const
+    R operator()(const Arg& arg) const
     {
-        return (*callable)(arg);
+        return m_operations->invoke(m_buffer, arg);
     }
 };
\ No newline at end of file
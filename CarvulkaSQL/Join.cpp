@@ -0,0 +1,327 @@
+#include "Join.hpp"
+#include <bit>
+
+using namespace std;
+
+bool is_qualified_column_name(const StringView& name, const StringView& table_name, const StringView& column_name)
+{
+    return name.size() == table_name.size() + 1 + column_name.size()
+        and StringView(name.data(), table_name.size()) == table_name and name[table_name.size()] == '.'
+        and StringView(name.data() + table_name.size() + 1, column_name.size()) == column_name;
+}
+
+/* JoinSource */
+
+JoinSource::JoinSource(const Table* table, Vector<size_t>&& row_positions) : table(table), row_positions(move(row_positions)) {}
+
+/* join ordering */
+
+JoinCondition resolve_join_condition(const Vector<JoinSource>& sources, const StringView& lhs_column_name, const StringView& rhs_column_name)
+{
+    size_t source_positions[2] = { size_t(-1), size_t(-1) };
+    size_t column_positions[2] = { size_t(-1), size_t(-1) };
+    const StringView* column_names[2] = { &lhs_column_name, &rhs_column_name };
+    for (size_t k = 0; k < 2; k += 1)
+    {
+        const StringView& name = *column_names[k];
+        size_t dot_pos = name.find('.');
+        if (dot_pos == -1) throw exception("invalid match condition");
+
+        for (size_t i = 0; i < sources.size(); i += 1)
+        {
+            if (sources[i].table->name() == name.slice(0, dot_pos))
+            {
+                source_positions[k] = i;
+                column_positions[k] = sources[i].table->find_column_by_name(name.slice(dot_pos + 1, name.size()));
+                break;
+            }
+        }
+        if (source_positions[k] == -1 or column_positions[k] == -1) throw exception("invalid match condition");
+    }
+    return JoinCondition{ source_positions[0], column_positions[0], source_positions[1], column_positions[1] };
+}
+
+double estimate_join_cardinality(const Vector<JoinSource>& sources, const Vector<JoinCondition>& conditions, uint64_t source_set)
+{
+    double cardinality = 1.0;
+    for (size_t i = 0; i < sources.size(); i += 1)
+    {
+        if (source_set & (uint64_t(1) << i))
+        {
+            cardinality *= static_cast<double>(sources[i].row_positions.size());
+        }
+    }
+    // an equi-join keeps 1 / max(distinct lhs keys, distinct rhs keys) of the cross product, assuming the smaller key set is contained in the larger
+    for (size_t i = 0; i < conditions.size(); i += 1)
+    {
+        const JoinCondition& condition = conditions[i];
+        if (not (source_set & (uint64_t(1) << condition.lhs_source_pos)) or not (source_set & (uint64_t(1) << condition.rhs_source_pos))) continue;
+
+        const JoinSource& lhs = sources[condition.lhs_source_pos];
+        const JoinSource& rhs = sources[condition.rhs_source_pos];
+        // the scans may have filtered the tables, which can only lower their distinct counts
+        double lhs_distinct_count = min(lhs.table->estimate_distinct_count(condition.lhs_column_pos), static_cast<double>(lhs.row_positions.size()));
+        double rhs_distinct_count = min(rhs.table->estimate_distinct_count(condition.rhs_column_pos), static_cast<double>(rhs.row_positions.size()));
+        cardinality /= max(1.0, max(lhs_distinct_count, rhs_distinct_count));
+    }
+    return cardinality;
+}
+
+bool is_connected_to(const Vector<JoinCondition>& conditions, size_t source_pos, uint64_t source_set)
+{
+    for (size_t i = 0; i < conditions.size(); i += 1)
+    {
+        if ((conditions[i].lhs_source_pos == source_pos and (source_set & (uint64_t(1) << conditions[i].rhs_source_pos)))
+            or (conditions[i].rhs_source_pos == source_pos and (source_set & (uint64_t(1) << conditions[i].lhs_source_pos))))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+Vector<size_t> find_join_order(const Vector<JoinSource>& sources, const Vector<JoinCondition>& conditions)
+{
+    size_t source_count = sources.size();
+    Vector<size_t> order;
+    order.resize_capacity_to(source_count);
+    if (source_count == 0) return order;
+
+    if (source_count <= MAX_EXHAUSTIVE_JOIN_SOURCE_COUNT)
+    {
+        // dynamic programming over subsets: the cheapest left-deep order of a set ends in the source whose removal leaves the cheapest connected set
+        size_t set_count = size_t(1) << source_count;
+        Vector<double> costs(set_count, -1.0); // -1 marks a set with no order free of cross products
+        Vector<size_t> last_source_positions(set_count, size_t(-1));
+        for (size_t i = 0; i < source_count; i += 1)
+        {
+            costs[size_t(1) << i] = 0.0;
+            last_source_positions[size_t(1) << i] = i;
+        }
+        for (uint64_t source_set = 1; source_set < set_count; source_set += 1)
+        {
+            if (popcount(source_set) < 2) continue;
+
+            double cardinality = estimate_join_cardinality(sources, conditions, source_set);
+            for (size_t i = 0; i < source_count; i += 1)
+            {
+                uint64_t source_bit = uint64_t(1) << i;
+                if (not (source_set & source_bit)) continue;
+
+                uint64_t subset = source_set & ~source_bit;
+                if (costs[subset] < 0.0 or not is_connected_to(conditions, i, subset)) continue;
+
+                double cost = costs[subset] + cardinality;
+                if (costs[source_set] < 0.0 or cost < costs[source_set])
+                {
+                    costs[source_set] = cost;
+                    last_source_positions[source_set] = i;
+                }
+            }
+        }
+
+        uint64_t source_set = set_count - 1;
+        if (costs[source_set] >= 0.0)
+        {
+            while (source_set != 0)
+            {
+                order.insert(0, last_source_positions[source_set]);
+                source_set &= ~(uint64_t(1) << last_source_positions[source_set]);
+            }
+            return order;
+        }
+        // the sources aren't connected, so some cross product is unavoidable; the greedy search below handles that
+    }
+
+    // greedy: start from the smallest source and keep adding the connected source that yields the smallest result
+    uint64_t source_set = 0;
+    size_t first_source_pos = 0;
+    for (size_t i = 1; i < source_count; i += 1)
+    {
+        if (sources[i].row_positions.size() < sources[first_source_pos].row_positions.size())
+        {
+            first_source_pos = i;
+        }
+    }
+    order.append(first_source_pos);
+    source_set |= uint64_t(1) << first_source_pos;
+    while (order.size() < source_count)
+    {
+        size_t best_source_pos = -1;
+        bool is_best_connected = false;
+        double best_cardinality = 0.0;
+        for (size_t i = 0; i < source_count; i += 1)
+        {
+            if (source_set & (uint64_t(1) << i)) continue;
+
+            bool is_connected = is_connected_to(conditions, i, source_set);
+            double cardinality = estimate_join_cardinality(sources, conditions, source_set | (uint64_t(1) << i));
+            if (best_source_pos == -1 or (is_connected and not is_best_connected) or (is_connected == is_best_connected and cardinality < best_cardinality))
+            {
+                best_source_pos = i;
+                is_best_connected = is_connected;
+                best_cardinality = cardinality;
+            }
+        }
+        order.append(best_source_pos);
+        source_set |= uint64_t(1) << best_source_pos;
+    }
+    return order;
+}
+
+/* JoinedRows */
+
+// keys the dictionaries of both columns share compare by the classes of their codes, @lhs_class_codes being translated into the rhs dictionary's
+static bool are_join_keys_equal(const Cell* lhs_key, const Cell* rhs_key, const Vector<uint32_t>& lhs_class_codes, const Vector<uint32_t>& rhs_class_codes)
+{
+    if (lhs_key != nullptr and rhs_key != nullptr and lhs_key->data_type == DataType::STRING and rhs_key->data_type == DataType::STRING)
+    {
+        uint32_t lhs_code = static_cast<const StringCell*>(lhs_key)->dictionary_code;
+        uint32_t rhs_code = static_cast<const StringCell*>(rhs_key)->dictionary_code;
+        if (lhs_code < lhs_class_codes.size() and rhs_code < rhs_class_codes.size())
+        {
+            return lhs_class_codes[lhs_code] != NO_DICTIONARY_CODE and lhs_class_codes[lhs_code] == rhs_class_codes[rhs_code];
+        }
+    }
+    return compare(lhs_key, rhs_key) == partial_ordering::equivalent;
+}
+
+JoinedRows::JoinedRows(Vector<JoinSource>&& sources, size_t first_source_pos) : m_sources(move(sources)), m_is_joined(), m_tuples()
+{
+    if (first_source_pos >= m_sources.size()) throw exception("source pos out of bounds");
+
+    m_is_joined = Vector<bool>(m_sources.size(), false);
+    m_is_joined[first_source_pos] = true;
+
+    const Vector<size_t>& row_positions = m_sources[first_source_pos].row_positions;
+    m_tuples.resize_to(row_positions.size() * m_sources.size());
+    for (size_t i = 0; i < row_positions.size(); i += 1)
+    {
+        m_tuples[i * m_sources.size() + first_source_pos] = row_positions[i];
+    }
+}
+
+const Vector<JoinSource>& JoinedRows::sources() const
+{
+    return m_sources;
+}
+size_t JoinedRows::tuple_count() const
+{
+    return m_tuples.size() / m_sources.size();
+}
+
+void JoinedRows::join(size_t source_pos, const Vector<JoinCondition>& conditions)
+{
+    if (source_pos >= m_sources.size() or m_is_joined[source_pos]) throw exception("source pos out of bounds");
+    if (conditions.is_empty()) throw exception("invalid match condition");
+
+    // orient every condition as (joined source, column) = (new source, column)
+    Vector<size_t> lhs_source_positions;
+    Vector<size_t> lhs_column_positions;
+    Vector<size_t> rhs_column_positions;
+    for (size_t i = 0; i < conditions.size(); i += 1)
+    {
+        const JoinCondition& condition = conditions[i];
+        if (condition.rhs_source_pos == source_pos and m_is_joined[condition.lhs_source_pos])
+        {
+            lhs_source_positions.append(condition.lhs_source_pos);
+            lhs_column_positions.append(condition.lhs_column_pos);
+            rhs_column_positions.append(condition.rhs_column_pos);
+        }
+        else if (condition.lhs_source_pos == source_pos and m_is_joined[condition.rhs_source_pos])
+        {
+            lhs_source_positions.append(condition.rhs_source_pos);
+            lhs_column_positions.append(condition.rhs_column_pos);
+            rhs_column_positions.append(condition.lhs_column_pos);
+        }
+        else
+        {
+            throw exception("invalid match condition");
+        }
+    }
+
+    size_t stride = m_sources.size();
+    const JoinSource& rhs_source = m_sources[source_pos];
+
+    // the codes of string keys are translated once per distinct value, so that the rows compare integers
+    // the rhs classes are taken first: a value the rhs dictionary gets in between is then left to compare() on both sides
+    Vector<Vector<uint32_t>> lhs_class_codes;
+    Vector<Vector<uint32_t>> rhs_class_codes;
+    for (size_t k = 0; k < lhs_source_positions.size(); k += 1)
+    {
+        const Table& lhs_table = *m_sources[lhs_source_positions[k]].table;
+        rhs_class_codes.append(rhs_source.table->find_dictionary_class_codes(rhs_column_positions[k]));
+        lhs_class_codes.append(lhs_table.translate_dictionary_codes(lhs_column_positions[k], *rhs_source.table, rhs_column_positions[k]));
+    }
+
+    Vector<size_t> tuples;
+    for (size_t i = 0; i < tuple_count(); i += 1)
+    {
+        for (size_t j = 0; j < rhs_source.row_positions.size(); j += 1)
+        {
+            const Vector<Cell*>& rhs_row = rhs_source.table->row(rhs_source.row_positions[j]);
+            bool is_match = true;
+            for (size_t k = 0; is_match and k < lhs_source_positions.size(); k += 1)
+            {
+                const Cell* lhs_key = m_sources[lhs_source_positions[k]].table->row(m_tuples[i * stride + lhs_source_positions[k]])[lhs_column_positions[k]];
+                is_match = are_join_keys_equal(lhs_key, rhs_row[rhs_column_positions[k]], lhs_class_codes[k], rhs_class_codes[k]);
+            }
+            if (is_match)
+            {
+                // appended rather than resized to, which would reallocate to the exact size on every match
+                size_t tuple_pos = tuples.size();
+                tuples.append(m_tuples.view(i * stride, (i + 1) * stride));
+                tuples[tuple_pos + source_pos] = rhs_source.row_positions[j];
+            }
+        }
+    }
+    m_tuples = move(tuples);
+    m_is_joined[source_pos] = true;
+}
+
+AnonymousTable JoinedRows::materialize(const Vector<String>& column_names) const
+{
+    bool selects_all_columns = column_names.contains("*");
+
+    // (source, column) pairs of the columns that make it into the result
+    Vector<size_t> source_positions;
+    Vector<size_t> column_positions;
+    Vector<Column> columns;
+    for (size_t i = 0; i < m_sources.size(); i += 1)
+    {
+        if (not m_is_joined[i]) continue;
+
+        const Table& table = *m_sources[i].table;
+        for (size_t j = 0; j < table.columns().size(); j += 1)
+        {
+            bool is_referenced = selects_all_columns;
+            for (size_t k = 0; not is_referenced and k < column_names.size(); k += 1)
+            {
+                is_referenced = is_qualified_column_name(column_names[k], table.name(), table.columns()[j].name());
+            }
+            if (not is_referenced) continue;
+
+            source_positions.append(i);
+            column_positions.append(j);
+            columns.append(Column(String(table.name()).append('.').append(table.columns()[j].name()), table.columns()[j].data_type()));
+        }
+    }
+
+    size_t stride = m_sources.size();
+    Vector<Vector<Cell*>> rows;
+    rows.resize_capacity_to(tuple_count());
+    for (size_t i = 0; i < tuple_count(); i += 1)
+    {
+        Vector<Cell*> row(columns.size(), nullptr);
+        for (size_t k = 0; k < columns.size(); k += 1)
+        {
+            const Cell* cell = m_sources[source_positions[k]].table->row(m_tuples[i * stride + source_positions[k]])[column_positions[k]];
+            if (cell != nullptr)
+            {
+                row[k] = cell->clone();
+            }
+        }
+        rows.append(move(row));
+    }
+    return AnonymousTable(move(columns), move(rows));
+}
\ No newline at end of file
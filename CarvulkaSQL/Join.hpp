@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Table.hpp"
+
+// a scanned table taking part in a join, kept as the positions of its qualifying rows instead of copies of them
+struct JoinSource
+{
+    const Table* table;
+    Vector<size_t> row_positions;
+
+    JoinSource(const Table* table, Vector<size_t>&& row_positions);
+};
+
+struct JoinCondition
+{
+    size_t lhs_source_pos;
+    size_t lhs_column_pos;
+    size_t rhs_source_pos;
+    size_t rhs_column_pos;
+};
+
+// resolves two qualified column names (table.column) to the sources and columns they refer to
+JoinCondition resolve_join_condition(const Vector<JoinSource>& sources, const StringView& lhs_column_name, const StringView& rhs_column_name);
+
+// estimated number of rows produced by joining the sources whose bits are set in @source_set on every condition among them
+double estimate_join_cardinality(const Vector<JoinSource>& sources, const Vector<JoinCondition>& conditions, uint64_t source_set);
+
+// picks the order of the sources that minimizes the summed estimated size of the intermediate results, never introducing a cross product when a connected source is left;
+// exhaustive over left-deep orders up to MAX_EXHAUSTIVE_JOIN_SOURCE_COUNT sources, greedy beyond
+constexpr size_t MAX_EXHAUSTIVE_JOIN_SOURCE_COUNT = 10;
+Vector<size_t> find_join_order(const Vector<JoinSource>& sources, const Vector<JoinCondition>& conditions);
+
+// joined rows are tuples of row ids, one per source; cells are only read through them until materialize() copies the referenced columns
+class JoinedRows
+{
+private:
+    Vector<JoinSource> m_sources;
+    Vector<bool> m_is_joined;
+    Vector<size_t> m_tuples; // m_sources.size() row ids per tuple, in source order
+public:
+    JoinedRows(Vector<JoinSource>&& sources, size_t first_source_pos);
+
+    const Vector<JoinSource>& sources() const;
+    size_t tuple_count() const;
+
+    // joins a source that isn't joined yet; every condition must relate it to a source that already is, and there must be at least one
+    void join(size_t source_pos, const Vector<JoinCondition>& conditions);
+
+    // copies the cells of the columns named in @column_names ('*' names every column) into a table whose columns are named table.column, in source order
+    AnonymousTable materialize(const Vector<String>& column_names) const;
+};
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "Latch.hpp"
+
+using namespace std;
+
+Latch::Latch() : m_mutex(), m_turnstile() {}
+
+void Latch::lock()
+{
+    // held while waiting, so that nobody can take the latch shared in the meantime
+    lock_guard<mutex> turnstile_lock(m_turnstile);
+    m_mutex.lock();
+}
+bool Latch::try_lock()
+{
+    return m_mutex.try_lock();
+}
+void Latch::unlock()
+{
+    m_mutex.unlock();
+}
+
+void Latch::lock_shared()
+{
+    {
+        lock_guard<mutex> turnstile_lock(m_turnstile);
+    }
+    m_mutex.lock_shared();
+}
+bool Latch::try_lock_shared()
+{
+    return m_mutex.try_lock_shared();
+}
+void Latch::unlock_shared()
+{
+    m_mutex.unlock_shared();
+}
\ No newline at end of file
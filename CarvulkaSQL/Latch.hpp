@@ -0,0 +1,26 @@
+#pragma once
+
+#include <shared_mutex>
+#include <mutex>
+
+// a reader-writer lock where an exclusive locker that waits keeps the shared lockers arriving after it out,
+// so that a steady stream of statements can't starve a schema change; shared locking isn't reentrant because of it
+class Latch
+{
+private:
+    std::shared_mutex m_mutex;
+    std::mutex m_turnstile;
+public:
+    Latch();
+
+    Latch(const Latch& other) = delete;
+    Latch& operator = (const Latch& other) = delete;
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+    void lock_shared();
+    bool try_lock_shared();
+    void unlock_shared();
+};
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "LikePattern.hpp"
+#include <cstring>
+
+using namespace std;
+
+static bool is_wildcard(char c)
+{
+    return c == '%' or c == '_';
+}
+
+// @lowercase_literal must already be lowercased
+static bool equals_lowercase(const char* data, const StringView& lowercase_literal)
+{
+    for (size_t i = 0; i < lowercase_literal.size(); i += 1)
+    {
+        if (Char::to_lowercase(data[i]) != lowercase_literal[i]) return false;
+    }
+    return true;
+}
+
+LikePattern::LikePattern(const StringView& pattern) : m_kind(Kind::GENERAL), m_text(), m_literal_prefix_size(0)
+{
+    size_t wildcard_count = 0;
+    size_t underscore_count = 0;
+    for (size_t i = 0; i < pattern.size(); i += 1)
+    {
+        if (is_wildcard(pattern[i]))
+        {
+            wildcard_count += 1;
+            underscore_count += pattern[i] == '_' ? 1 : 0;
+        }
+        else if (wildcard_count == 0)
+        {
+            m_literal_prefix_size += 1;
+        }
+    }
+
+    bool has_leading_percent = not pattern.is_empty() and pattern.front() == '%';
+    bool has_trailing_percent = not pattern.is_empty() and pattern.back() == '%' and (pattern.size() > 1 or not has_leading_percent);
+    size_t inner_wildcard_count = wildcard_count - (has_leading_percent ? 1 : 0) - (has_trailing_percent ? 1 : 0);
+
+    if (underscore_count == 0 and inner_wildcard_count == 0)
+    {
+        size_t start_pos = has_leading_percent ? 1 : 0;
+        size_t end_pos_excl = pattern.size() - (has_trailing_percent ? 1 : 0);
+        m_text = pattern.slice(start_pos, end_pos_excl);
+        m_kind = has_leading_percent and has_trailing_percent ? Kind::CONTAINS : has_leading_percent ? Kind::SUFFIX : has_trailing_percent ? Kind::PREFIX : Kind::EXACT;
+    }
+    else
+    {
+        m_text = pattern;
+    }
+    m_text.to_lowercase();
+}
+
+LikePattern::Kind LikePattern::kind() const
+{
+    return m_kind;
+}
+StringView LikePattern::literal_prefix() const
+{
+    if (m_kind == Kind::SUFFIX or m_kind == Kind::CONTAINS) return StringView();
+    return StringView(m_text, m_literal_prefix_size);
+}
+
+bool LikePattern::matches(const StringView& string) const
+{
+    switch (m_kind)
+    {
+    case Kind::EXACT:
+    {
+        return string.size() == m_text.size() and equals_lowercase(string.data(), m_text);
+    }
+    case Kind::PREFIX:
+    {
+        return string.size() >= m_text.size() and equals_lowercase(string.data(), m_text);
+    }
+    case Kind::SUFFIX:
+    {
+        return string.size() >= m_text.size() and equals_lowercase(string.data() + string.size() - m_text.size(), m_text);
+    }
+    case Kind::CONTAINS:
+    {
+        return find_literal_in(string) != -1;
+    }
+    default:
+    {
+        return matches_general(string);
+    }
+    }
+}
+
+size_t LikePattern::find_literal_in(const StringView& string) const
+{
+    if (m_text.is_empty()) return 0;
+    if (string.size() < m_text.size()) return -1;
+
+    // memchr skips to the candidates starting with the literal's first character, in either case
+    const char* data = string.data();
+    const char lower = m_text[0];
+    const char upper = Char::to_uppercase(lower);
+    size_t last_start_pos = string.size() - m_text.size();
+    size_t curr_pos = 0;
+    while (curr_pos <= last_start_pos)
+    {
+        size_t search_size = last_start_pos - curr_pos + 1;
+        const char* lower_match = static_cast<const char*>(memchr(data + curr_pos, lower, search_size));
+        const char* match = lower_match;
+        if (upper != lower)
+        {
+            const char* upper_match = static_cast<const char*>(memchr(data + curr_pos, upper, lower_match == nullptr ? search_size : lower_match - (data + curr_pos)));
+            match = upper_match != nullptr ? upper_match : lower_match;
+        }
+        if (match == nullptr) return -1;
+
+        size_t match_pos = match - data;
+        if (equals_lowercase(match + 1, StringView(m_text.data() + 1, m_text.size() - 1))) return match_pos;
+        curr_pos = match_pos + 1;
+    }
+    return -1;
+}
+
+bool LikePattern::matches_general(const StringView& string) const
+{
+    // on a mismatch only the last '%' needs to be retried one character further, which keeps this O(pattern * string)
+    size_t pattern_pos = 0;
+    size_t string_pos = 0;
+    size_t last_percent_pos = -1;
+    size_t retry_string_pos = 0;
+    while (string_pos < string.size())
+    {
+        if (pattern_pos < m_text.size() and m_text[pattern_pos] == '%')
+        {
+            last_percent_pos = pattern_pos;
+            retry_string_pos = string_pos;
+            pattern_pos += 1;
+        }
+        else if (pattern_pos < m_text.size() and (m_text[pattern_pos] == '_' or m_text[pattern_pos] == Char::to_lowercase(string[string_pos])))
+        {
+            pattern_pos += 1;
+            string_pos += 1;
+        }
+        else if (last_percent_pos != -1)
+        {
+            pattern_pos = last_percent_pos + 1;
+            retry_string_pos += 1;
+            string_pos = retry_string_pos;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (pattern_pos < m_text.size() and m_text[pattern_pos] == '%')
+    {
+        pattern_pos += 1;
+    }
+    return pattern_pos == m_text.size();
+}
\ No newline at end of file
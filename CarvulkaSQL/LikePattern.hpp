@@ -0,0 +1,34 @@
+#pragma once
+
+#include "String.hpp"
+
+// a pattern for 'is like', compiled once per query: '%' matches any run of characters and '_' any single character
+// matching is case insensitive like every other string comparison, and never allocates
+class LikePattern
+{
+public:
+    enum class Kind : uint8_t
+    {
+        EXACT,    // 'abc'
+        PREFIX,   // 'abc%'
+        SUFFIX,   // '%abc'
+        CONTAINS, // '%abc%'
+        GENERAL   // anything else, matched by backtracking to the last '%'
+    };
+private:
+    Kind m_kind;
+    // lowercased; the literal of the fast paths, or the whole pattern for GENERAL
+    String m_text;
+    size_t m_literal_prefix_size;
+private:
+    bool matches_general(const StringView& string) const;
+    size_t find_literal_in(const StringView& string) const;
+public:
+    LikePattern(const StringView& pattern);
+
+    Kind kind() const;
+    // the characters every matching string starts with, for narrowing a search on an ordered index
+    StringView literal_prefix() const;
+
+    bool matches(const StringView& string) const;
+};
\ No newline at end of file
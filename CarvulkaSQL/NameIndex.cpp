@@ -0,0 +1,84 @@
+#include "NameIndex.hpp"
+
+using namespace std;
+
+size_t NameIndex::find_slot(const StringView& name) const
+{
+    size_t mask = m_slots.size() - 1;
+    size_t slot_pos = case_insensitive_hash(name) & mask;
+    while (m_slots[slot_pos] != 0 and m_names[m_slots[slot_pos] - 1] != name)
+    {
+        slot_pos = (slot_pos + 1) & mask;
+    }
+    return slot_pos;
+}
+
+void NameIndex::rehash(size_t slot_count)
+{
+    m_slots = Vector<uint32_t>(slot_count, 0);
+    for (size_t i = 0; i < m_names.size(); i += 1)
+    {
+        size_t slot_pos = find_slot(m_names[i]);
+        // an equal name before it keeps the slot
+        if (m_slots[slot_pos] == 0)
+        {
+            m_slots[slot_pos] = static_cast<uint32_t>(i + 1);
+        }
+    }
+}
+
+NameIndex::NameIndex() : m_names(), m_slots() {}
+
+size_t NameIndex::size() const
+{
+    return m_names.size();
+}
+
+size_t NameIndex::find(const StringView& name) const
+{
+    if (m_slots.is_empty()) return -1;
+
+    size_t slot_pos = find_slot(name);
+    if (m_slots[slot_pos] == 0) return -1;
+    return m_slots[slot_pos] - 1;
+}
+
+void NameIndex::append(const StringView& name)
+{
+    m_names.append(String(name));
+    // at most half the slots are taken, so that the runs stay short
+    if (2 * m_names.size() > m_slots.size())
+    {
+        rehash(max(2 * m_slots.size(), MIN_SLOT_COUNT));
+        return;
+    }
+
+    size_t slot_pos = find_slot(name);
+    if (m_slots[slot_pos] == 0)
+    {
+        m_slots[slot_pos] = static_cast<uint32_t>(m_names.size());
+    }
+}
+
+// renaming and erasing are schema changes, rare enough to rebuild the slots for
+void NameIndex::rename(size_t pos, const StringView& new_name)
+{
+    if (m_names.is_empty() or pos > m_names.size() - 1) return;
+
+    m_names[pos] = new_name;
+    rehash(m_slots.size());
+}
+
+void NameIndex::erase(size_t pos)
+{
+    if (m_names.is_empty() or pos > m_names.size() - 1) return;
+
+    m_names.erase(pos);
+    rehash(m_slots.size());
+}
+
+void NameIndex::clear()
+{
+    m_names.clear();
+    m_slots.clear();
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Vector.hpp"
+#include "String.hpp"
+
+// the names of a catalog's tables or a table's columns by position, hashed so that a name is looked up without comparing it to every other one
+// names are compared like everywhere else, regardless of case; where several positions hold equal names, find() returns the first, as a scan would
+// kept by its owner alongside the objects it names: appending, renaming and erasing one has to be done here as well
+class NameIndex
+{
+public:
+    static constexpr size_t MIN_SLOT_COUNT = 16;
+private:
+    Vector<String> m_names; // by position
+    // open addressing on the case-insensitive hash; position + 1 of the first of equal names, 0 for an empty slot
+    Vector<uint32_t> m_slots;
+private:
+    // the slot holding @name, or the empty one ending its run
+    size_t find_slot(const StringView& name) const;
+    void rehash(size_t slot_count);
+public:
+    NameIndex();
+
+    size_t size() const;
+
+    // -1 if no position holds @name
+    size_t find(const StringView& name) const;
+
+    void append(const StringView& name);
+    void rename(size_t pos, const StringView& new_name);
+    // the positions after @pos move down by one
+    void erase(size_t pos);
+    void clear();
+};
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "OutputBuffer.hpp"
+
+using namespace std;
+
+OutputBuffer::OutputBuffer(std::ostream& os) : m_os(os), m_text()
+{
+    m_text.resize_capacity_to(FLUSH_THRESHOLD);
+}
+OutputBuffer::~OutputBuffer() noexcept
+{
+    flush();
+}
+
+void OutputBuffer::reserve(size_t extra_size)
+{
+    if (m_text.size() + extra_size > m_text.capacity())
+    {
+        m_text.resize_capacity_to(max(2 * m_text.capacity(), m_text.size() + extra_size));
+    }
+}
+
+String& OutputBuffer::text()
+{
+    return m_text;
+}
+
+OutputBuffer& OutputBuffer::append(char character)
+{
+    m_text.append(character);
+    return *this;
+}
+OutputBuffer& OutputBuffer::append(const StringView& string)
+{
+    m_text.append(string);
+    return *this;
+}
+OutputBuffer& OutputBuffer::append_repeated(char character, size_t count)
+{
+    reserve(count);
+    size_t start_pos = m_text.size();
+    m_text.resize_to(start_pos + count);
+    for (size_t i = 0; i < count; i += 1)
+    {
+        m_text[start_pos + i] = character;
+    }
+    return *this;
+}
+
+void OutputBuffer::flush_if_full()
+{
+    if (m_text.size() >= FLUSH_THRESHOLD)
+    {
+        flush();
+    }
+}
+void OutputBuffer::flush()
+{
+    if (m_text.is_empty()) return;
+    m_os.write(m_text.data(), m_text.size());
+    m_os.flush();
+    m_text.clear();
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "String.hpp"
+#include <ostream>
+
+// text on its way to a stream, gathered so that it is written out in large blocks
+class OutputBuffer
+{
+public:
+    static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+private:
+    std::ostream& m_os;
+    String m_text;
+private:
+    // grows the capacity geometrically, so that appending never reallocates per row
+    void reserve(size_t extra_size);
+public:
+    OutputBuffer(std::ostream& os);
+
+    OutputBuffer(const OutputBuffer& other) = delete;
+    // writes out what is still buffered
+    ~OutputBuffer() noexcept;
+    OutputBuffer& operator = (const OutputBuffer& other) = delete;
+
+    // for rendering cells straight into the buffer
+    String& text();
+
+    OutputBuffer& append(char character);
+    OutputBuffer& append(const StringView& string);
+    OutputBuffer& append_repeated(char character, size_t count);
+
+    // called after each row, so that the buffer stays around FLUSH_THRESHOLD
+    void flush_if_full();
+    void flush();
+};
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include "OutputFormat.hpp"
+#include "TableFormatter.hpp"
+#include "WireProtocol.hpp"
+
+using namespace std;
+
+static void append_csv_field_to(OutputBuffer& output, const StringView& field)
+{
+    bool needs_quotes = false;
+    for (size_t i = 0; i < field.size(); i += 1)
+    {
+        needs_quotes = needs_quotes or field[i] == ',' or field[i] == '"' or field[i] == '\n' or field[i] == '\r';
+    }
+    if (not needs_quotes)
+    {
+        output.append(field);
+        return;
+    }
+
+    output.append('"');
+    for (size_t i = 0; i < field.size(); i += 1)
+    {
+        // a quote inside a quoted field is doubled
+        if (field[i] == '"')
+        {
+            output.append('"');
+        }
+        output.append(field[i]);
+    }
+    output.append('"');
+}
+
+static void append_json_string_to(OutputBuffer& output, const StringView& string)
+{
+    static const char* HEX_DIGITS = "0123456789abcdef";
+    output.append('"');
+    for (size_t i = 0; i < string.size(); i += 1)
+    {
+        char character = string[i];
+        if (character == '"' or character == '\\')
+        {
+            output.append('\\').append(character);
+        }
+        else if (character == '\n')
+        {
+            output.append("\\n");
+        }
+        else if (character == '\r')
+        {
+            output.append("\\r");
+        }
+        else if (character == '\t')
+        {
+            output.append("\\t");
+        }
+        else if (static_cast<unsigned char>(character) < 0x20)
+        {
+            output.append("\\u00").append(HEX_DIGITS[character >> 4]).append(HEX_DIGITS[character & 0xF]);
+        }
+        else
+        {
+            output.append(character);
+        }
+    }
+    output.append('"');
+}
+
+OutputFormat convert_string_to_output_format(const StringView& string)
+{
+    if (string == "table") return OutputFormat::TABLE;
+    if (string == "csv") return OutputFormat::CSV;
+    if (string == "jsonl") return OutputFormat::JSON_LINES;
+    if (string == "binary") return OutputFormat::BINARY;
+    return OutputFormat::INVALID;
+}
+
+void write_table_to(std::ostream& os, Cursor& cursor)
+{
+    if (cursor.columns().is_empty())
+    {
+        os << "Empty set\n";
+        return;
+    }
+
+    OutputBuffer output(os);
+    TableFormatter formatter(output);
+    Selection batch(cursor.columns());
+    Vector<size_t> cell_widths = move(TableFormatter::measure_column_names(cursor.columns()));
+    bool has_rows = false;
+    while (cursor.fetch_into(batch))
+    {
+        formatter.render(batch);
+        Vector<size_t> batch_cell_widths = cell_widths;
+        bool is_wider = formatter.widen(batch_cell_widths);
+        if (has_rows and is_wider)
+        {
+            formatter.write_border(cell_widths);
+        }
+        if (not has_rows or is_wider)
+        {
+            cell_widths = move(batch_cell_widths);
+            formatter.write_header(cursor.columns(), cell_widths);
+        }
+        formatter.write_rows(cell_widths);
+        has_rows = true;
+    }
+
+    if (has_rows)
+    {
+        formatter.write_border(cell_widths);
+    }
+    else
+    {
+        formatter.write_header(cursor.columns(), cell_widths);
+    }
+}
+
+void write_csv_to(std::ostream& os, Cursor& cursor)
+{
+    const Vector<Column>& columns = cursor.columns();
+    if (columns.is_empty()) return;
+
+    OutputBuffer output(os);
+    for (size_t i = 0; i < columns.size(); i += 1)
+    {
+        if (i > 0)
+        {
+            output.append(',');
+        }
+        append_csv_field_to(output, columns[i].name());
+    }
+    output.append('\n');
+
+    Selection batch(columns);
+    while (cursor.fetch_into(batch))
+    {
+        for (size_t i = 0; i < batch.rows().size(); i += 1)
+        {
+            const Vector<Cell*>& row = batch.rows()[i];
+            for (size_t j = 0; j < row.size(); j += 1)
+            {
+                if (j > 0)
+                {
+                    output.append(',');
+                }
+                if (row[j] == nullptr) continue;
+                if (row[j]->data_type == DataType::STRING)
+                {
+                    append_csv_field_to(output, static_cast<const StringCell*>(row[j])->value);
+                }
+                else
+                {
+                    row[j]->append_to(output.text());
+                }
+            }
+            output.append('\n');
+            output.flush_if_full();
+        }
+    }
+}
+
+void write_json_lines_to(std::ostream& os, Cursor& cursor)
+{
+    const Vector<Column>& columns = cursor.columns();
+    if (columns.is_empty()) return;
+
+    OutputBuffer output(os);
+    Selection batch(columns);
+    while (cursor.fetch_into(batch))
+    {
+        for (size_t i = 0; i < batch.rows().size(); i += 1)
+        {
+            const Vector<Cell*>& row = batch.rows()[i];
+            output.append('{');
+            for (size_t j = 0; j < row.size(); j += 1)
+            {
+                if (j > 0)
+                {
+                    output.append(',');
+                }
+                append_json_string_to(output, columns[j].name());
+                output.append(':');
+                if (row[j] == nullptr)
+                {
+                    output.append("null");
+                }
+                else if (row[j]->data_type == DataType::STRING)
+                {
+                    append_json_string_to(output, static_cast<const StringCell*>(row[j])->value);
+                }
+                else
+                {
+                    row[j]->append_to(output.text());
+                }
+            }
+            output.append("}\n");
+            output.flush_if_full();
+        }
+    }
+}
+
+void write_binary_to(std::ostream& os, Cursor& cursor)
+{
+    Vector<uint8_t> frames;
+    append_columns_frame_to(frames, cursor.columns());
+    Selection batch(cursor.columns());
+    while (cursor.fetch_into(batch))
+    {
+        append_columnar_frame_to(frames, batch);
+        if (frames.size() < OutputBuffer::FLUSH_THRESHOLD) continue;
+        os.write(reinterpret_cast<const char*>(frames.data()), frames.size());
+        frames.clear();
+    }
+    os.write(reinterpret_cast<const char*>(frames.data()), frames.size());
+    os.flush();
+}
+
+void write_rows_to(std::ostream& os, Cursor& cursor, OutputFormat format)
+{
+    switch (format)
+    {
+    case OutputFormat::CSV:
+    {
+        write_csv_to(os, cursor);
+        break;
+    }
+    case OutputFormat::JSON_LINES:
+    {
+        write_json_lines_to(os, cursor);
+        break;
+    }
+    case OutputFormat::BINARY:
+    {
+        write_binary_to(os, cursor);
+        break;
+    }
+    default:
+    {
+        write_table_to(os, cursor);
+        break;
+    }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Cursor.hpp"
+#include <ostream>
+
+// how the console writes the rows a statement selected, chosen per session with 'set output = ...'
+enum class OutputFormat : uint8_t
+{
+    INVALID, TABLE, CSV, JSON_LINES, BINARY
+};
+
+// 'table', 'csv', 'jsonl' or 'binary'
+OutputFormat convert_string_to_output_format(const StringView& string);
+
+// the rows are written as they are fetched, none of the formats but the table needs to see them all first
+
+// boxed, for reading at the console; the header is repeated whenever a batch widens a column
+void write_table_to(std::ostream& os, Cursor& cursor);
+// RFC 4180: a line with the column names, then a line per row; nulls are empty fields
+void write_csv_to(std::ostream& os, Cursor& cursor);
+// a JSON object per row, keyed by the column names
+void write_json_lines_to(std::ostream& os, Cursor& cursor);
+// a COLUMNS frame, then a COLUMNAR frame per batch, the way the server sends them
+void write_binary_to(std::ostream& os, Cursor& cursor);
+
+void write_rows_to(std::ostream& os, Cursor& cursor, OutputFormat format);
\ No newline at end of file
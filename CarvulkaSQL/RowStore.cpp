@@ -0,0 +1,126 @@
+#include "RowStore.hpp"
+#include <bit>
+
+using namespace std;
+
+void RowStore::free()
+{
+    for (size_t i = 0; i < MAX_CHUNK_COUNT; i += 1)
+    {
+        delete[] m_chunks[i];
+        m_chunks[i] = nullptr;
+    }
+}
+
+size_t RowStore::find_chunk_of(size_t pos)
+{
+    // chunk k starts at FIRST_CHUNK_SIZE * (2^k - 1)
+    return bit_width(pos / FIRST_CHUNK_SIZE + 1) - 1;
+}
+size_t RowStore::find_chunk_start(size_t chunk_pos)
+{
+    return FIRST_CHUNK_SIZE * ((size_t(1) << chunk_pos) - 1);
+}
+
+RowStore::RowStore() : m_chunks(), m_size(0) {}
+
+RowStore::RowStore(RowStore&& other) noexcept : m_chunks(), m_size(other.m_size.load())
+{
+    for (size_t i = 0; i < MAX_CHUNK_COUNT; i += 1)
+    {
+        m_chunks[i] = other.m_chunks[i];
+        other.m_chunks[i] = nullptr;
+    }
+    other.m_size.store(0);
+}
+RowStore::~RowStore() noexcept
+{
+    free();
+}
+RowStore& RowStore::operator = (RowStore&& other) noexcept
+{
+    if (this != &other)
+    {
+        free();
+        for (size_t i = 0; i < MAX_CHUNK_COUNT; i += 1)
+        {
+            m_chunks[i] = other.m_chunks[i];
+            other.m_chunks[i] = nullptr;
+        }
+        m_size.store(other.m_size.load());
+        other.m_size.store(0);
+    }
+    return *this;
+}
+
+size_t RowStore::size() const
+{
+    return m_size.load(memory_order_acquire);
+}
+bool RowStore::is_empty() const
+{
+    return size() == 0;
+}
+size_t RowStore::capacity() const
+{
+    size_t chunk_count = 0;
+    while (chunk_count < MAX_CHUNK_COUNT and m_chunks[chunk_count] != nullptr)
+    {
+        chunk_count += 1;
+    }
+    return find_chunk_start(chunk_count);
+}
+
+const StoredRow& RowStore::operator [] (size_t pos) const
+{
+    size_t chunk_pos = find_chunk_of(pos);
+    return m_chunks[chunk_pos][pos - find_chunk_start(chunk_pos)];
+}
+StoredRow& RowStore::operator [] (size_t pos)
+{
+    size_t chunk_pos = find_chunk_of(pos);
+    return m_chunks[chunk_pos][pos - find_chunk_start(chunk_pos)];
+}
+const StoredRow& RowStore::back() const
+{
+    return (*this)[size() - 1];
+}
+StoredRow& RowStore::back()
+{
+    return (*this)[size() - 1];
+}
+
+void RowStore::append(Vector<Cell*>&& cells, const RowVersion& version)
+{
+    size_t pos = m_size.load(memory_order_relaxed);
+    size_t chunk_pos = find_chunk_of(pos);
+    if (chunk_pos >= MAX_CHUNK_COUNT) throw exception("too many rows");
+    if (m_chunks[chunk_pos] == nullptr)
+    {
+        m_chunks[chunk_pos] = new StoredRow[FIRST_CHUNK_SIZE << chunk_pos];
+    }
+    StoredRow& row = m_chunks[chunk_pos][pos - find_chunk_start(chunk_pos)];
+    row.cells = move(cells);
+    row.version = version;
+    // publishes the row written above
+    m_size.store(pos + 1, memory_order_release);
+}
+
+void RowStore::truncate_to(size_t new_size)
+{
+    size_t old_size = size();
+    for (size_t i = new_size; i < old_size; i += 1)
+    {
+        (*this)[i].cells = Vector<Cell*>();
+    }
+    m_size.store(min(new_size, old_size), memory_order_release);
+}
+void RowStore::shrink_to_fit()
+{
+    size_t used_chunk_count = is_empty() ? 0 : find_chunk_of(size() - 1) + 1;
+    for (size_t i = used_chunk_count; i < MAX_CHUNK_COUNT; i += 1)
+    {
+        delete[] m_chunks[i];
+        m_chunks[i] = nullptr;
+    }
+}
\ No newline at end of file
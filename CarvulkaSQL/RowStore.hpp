@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Vector.hpp"
+#include "Cell.hpp"
+#include "Version.hpp"
+
+struct StoredRow
+{
+    Vector<Cell*> cells;
+    RowVersion version;
+};
+
+// the rows of a table in chunks that never move once allocated, chunk k holding FIRST_CHUNK_SIZE << k rows,
+// so that readers can scan the rows while the writer appends to them; doesn't own the cells
+class RowStore
+{
+public:
+    static constexpr size_t FIRST_CHUNK_SIZE = 64;
+    static constexpr size_t MAX_CHUNK_COUNT = 48;
+private:
+    StoredRow* m_chunks[MAX_CHUNK_COUNT];
+    // rows past it may be half written, readers don't look at them
+    std::atomic<size_t> m_size;
+private:
+    void free();
+    static size_t find_chunk_of(size_t pos);
+    static size_t find_chunk_start(size_t chunk_pos);
+public:
+    RowStore();
+
+    RowStore(const RowStore& other) = delete;
+    RowStore(RowStore&& other) noexcept;
+    ~RowStore() noexcept;
+    RowStore& operator = (const RowStore& other) = delete;
+    RowStore& operator = (RowStore&& other) noexcept;
+
+    size_t size() const;
+    bool is_empty() const;
+    // the allocated rows, used or not
+    size_t capacity() const;
+
+    const StoredRow& operator [] (size_t pos) const;
+    StoredRow& operator [] (size_t pos);
+    const StoredRow& back() const;
+    StoredRow& back();
+
+    // only a single writer may append at a time; the row becomes visible to readers once it is complete
+    void append(Vector<Cell*>&& cells, const RowVersion& version);
+    // drops the rows from @new_size on, which must not own cells any more; nobody may read the rows meanwhile
+    void truncate_to(size_t new_size);
+    // releases the chunks past the last row
+    void shrink_to_fit();
+};
\ No newline at end of file
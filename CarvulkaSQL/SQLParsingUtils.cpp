@@ -36,9 +36,9 @@ void format(String& string)
     string = move(temp);
 }
 
-Vector<String> tokenize(const StringView& string)
+Vector<String> tokenize(const StringView& string, Arena* arena)
 {
-    Vector<String> tokens;
+    Vector<String> tokens(arena);
     size_t curr_pos = 0;
     while (curr_pos < string.size())
     {
@@ -79,7 +79,8 @@ bool should_combine_keyword_tokens(const StringView& left, const StringView& rig
     return ((left == "create" or left == "drop" or left == "rename" or left == "alter" or left == "truncate" or left == "save") and right == "table")
         or ((left == "add" or left == "drop" or left == "rename") and right == "column") or (left == "list" and right == "tables")
         or (left == "insert" and right == "into") or (left == "delete" and right == "from") or (left == "order" and right == "by")
-        or (left == "is" and right == "null") or (left == "is" and right == "like");
+        or (left == "is" and right == "null") or (left == "is" and right == "like")
+        or (left == "show" and right == "statistics") or ((left == "create" or left == "drop") and right == "index");
 }
 
 Cell* parse_value_token(const StringView& token)
@@ -92,7 +93,7 @@ Cell* parse_value_token(const StringView& token)
     {
         return new StringCell(token.slice(1, token.size() - 1));
     }
-    else if (token.contains('.'))
+    else if (token.contains('.') or token.contains('e') or token.contains('E'))
     {
         try { return new RealCell(convert_string_to_real(token)); }
         catch (const exception& e) { throw e; }
@@ -104,7 +105,7 @@ Cell* parse_value_token(const StringView& token)
     }
 }
 
-Vector<Column> parse_column_definitions_clause(const Vector<String>& tokens)
+Vector<Column> parse_column_definitions_clause(const VectorView<String>& tokens)
 {
     Vector<Column> columns;
     size_t curr_pos = 0;
@@ -126,7 +127,7 @@ Vector<Column> parse_column_definitions_clause(const Vector<String>& tokens)
     return columns;
 }
 
-Vector<Cell*> parse_row(const Vector<String>& tokens)
+Vector<Cell*> parse_row(const VectorView<String>& tokens)
 {
     Vector<Cell*> row;
     size_t curr_pos = 0;
@@ -149,7 +150,7 @@ Vector<Cell*> parse_row(const Vector<String>& tokens)
     return row;
 }
 
-Vector<String> parse_select_clause(const Vector<String>& tokens)
+Vector<String> parse_select_clause(const VectorView<String>& tokens)
 {
     Vector<String> column_names;
     size_t curr_pos = 0;
@@ -201,10 +202,10 @@ uint8_t precedence(const StringView& op)
     return 0;
 }
 
-Vector<String> convert_to_postfix(const Vector<String>& tokens)
+Vector<String> convert_to_postfix(const VectorView<String>& tokens, Arena* arena)
 {
-    Vector<String> output;
-    Vector<String> operators;
+    Vector<String> output(arena);
+    Vector<String> operators(arena);
     for (size_t i = 0; i < tokens.size(); i += 1)
     {
         const StringView& token = tokens[i];
@@ -300,4 +301,166 @@ Function<bool, Vector<Cell*>> parse_is_null_condition(size_t column_pos, const S
         return [column_pos](const Vector<Cell*>& row) -> bool { return row[column_pos] == nullptr; };
     }
     throw exception("invalid operator");
+}
+
+Function<bool, Vector<Cell*>> parse_is_like_condition(size_t column_pos, const StringView& right, const StringView& op)
+{
+    if (op != "is like") throw exception("invalid operator");
+    if (right.size() < 2 or right.front() != '\'' or right.back() != '\'') throw exception("pattern must be a string");
+
+    LikePattern pattern(right.slice(1, right.size() - 1));
+    return [column_pos, pattern](const Vector<Cell*>& row) -> bool
+    {
+        if (row[column_pos] == nullptr or row[column_pos]->data_type != DataType::STRING) return false;
+        return pattern.matches(static_cast<const StringCell*>(row[column_pos])->value);
+    };
+}
+
+Function<bool, Vector<Cell*>> evaluate_on_codes(const AbstractTable* table, size_t column_pos, Function<bool, Vector<Cell*>>&& condition)
+{
+    Vector<bool> results = move(table->evaluate_on_dictionary(column_pos, condition));
+    if (results.is_empty()) return move(condition);
+
+    return [column_pos, results = move(results), condition = move(condition)](const Vector<Cell*>& row) -> bool
+    {
+        const Cell* cell = row[column_pos];
+        if (cell != nullptr and cell->data_type == DataType::STRING and static_cast<const StringCell*>(cell)->dictionary_code < results.size())
+        {
+            return results[static_cast<const StringCell*>(cell)->dictionary_code];
+        }
+        return condition(row);
+    };
+}
+
+bool is_value_token(const StringView& token)
+{
+    return token == "null" or token.front() == '\'' or Char::is_digit(token.front()) or token.front() == '-' or token.front() == '+' or token.front() == '.';
+}
+
+Vector<VectorView<String>> split_conjuncts(const VectorView<String>& tokens)
+{
+    Vector<VectorView<String>> conjuncts;
+    if (tokens.is_empty()) return conjuncts;
+
+    // unwrap a clause that is entirely enclosed in parentheses
+    if (tokens.front() == "(" and tokens.back() == ")")
+    {
+        size_t depth = 0;
+        size_t closing_pos = -1;
+        for (size_t i = 0; i < tokens.size(); i += 1)
+        {
+            if (tokens[i] == "(") depth += 1;
+            if (tokens[i] == ")") depth -= 1;
+            if (depth == 0)
+            {
+                closing_pos = i;
+                break;
+            }
+        }
+        if (closing_pos == tokens.size() - 1)
+        {
+            return split_conjuncts(tokens.slice(1, tokens.size() - 1));
+        }
+    }
+
+    // 'and' and 'or' share the same precedence, so splitting on 'and' is only sound when there is no top-level 'or'
+    size_t depth = 0;
+    for (size_t i = 0; i < tokens.size(); i += 1)
+    {
+        if (tokens[i] == "(") depth += 1;
+        if (tokens[i] == ")") depth -= 1;
+        if (depth == 0 and tokens[i] == "or")
+        {
+            conjuncts.append(tokens);
+            return conjuncts;
+        }
+    }
+
+    size_t curr_pos = 0;
+    depth = 0;
+    for (size_t i = 0; i <= tokens.size(); i += 1)
+    {
+        if (i < tokens.size() and tokens[i] == "(") depth += 1;
+        if (i < tokens.size() and tokens[i] == ")") depth -= 1;
+        if (i == tokens.size() or (depth == 0 and tokens[i] == "and"))
+        {
+            if (i == curr_pos) throw exception("invalid where clause");
+            conjuncts.append(tokens.slice(curr_pos, i));
+            curr_pos = i + 1;
+        }
+    }
+    return conjuncts;
+}
+
+Vector<String> combine_conjuncts(const Vector<VectorView<String>>& conjuncts, Arena* arena)
+{
+    Vector<String> tokens(arena);
+    for (size_t i = 0; i < conjuncts.size(); i += 1)
+    {
+        if (i != 0)
+        {
+            tokens.append(String("and"));
+        }
+        tokens.append(String("("));
+        tokens.append(conjuncts[i]);
+        tokens.append(String(")"));
+    }
+    return tokens;
+}
+
+Vector<String> find_column_names(const VectorView<String>& tokens)
+{
+    Vector<String> column_names;
+    for (size_t i = 0; i < tokens.size(); i += 1)
+    {
+        const String& token = tokens[i];
+        if (is_operator(token) or token == "(" or token == ")" or is_value_token(token)) continue;
+
+        column_names.append(token);
+    }
+    return column_names;
+}
+
+String find_qualifying_table_name(const VectorView<String>& tokens)
+{
+    String table_name;
+    for (size_t i = 0; i < tokens.size(); i += 1)
+    {
+        const String& token = tokens[i];
+        if (is_operator(token) or token == "(" or token == ")" or is_value_token(token)) continue;
+
+        size_t dot_pos = token.find('.');
+        if (dot_pos == -1 or dot_pos == 0) return String();
+
+        StringView curr_table_name(token, 0, dot_pos);
+        if (table_name.is_empty())
+        {
+            table_name = curr_table_name;
+        }
+        else if (table_name != curr_table_name)
+        {
+            return String();
+        }
+    }
+    return table_name;
+}
+
+Vector<String> unqualify_column_names(const VectorView<String>& tokens)
+{
+    Vector<String> unqualified_tokens;
+    unqualified_tokens.resize_capacity_to(tokens.size());
+    for (size_t i = 0; i < tokens.size(); i += 1)
+    {
+        const String& token = tokens[i];
+        size_t dot_pos = token.find('.');
+        if (is_operator(token) or token == "(" or token == ")" or is_value_token(token) or dot_pos == -1)
+        {
+            unqualified_tokens.append(token);
+        }
+        else
+        {
+            unqualified_tokens.append(token.slice(dot_pos + 1, token.size()));
+        }
+    }
+    return unqualified_tokens;
 }
\ No newline at end of file
@@ -3,10 +3,12 @@
 #include "String.hpp"
 #include "Vector.hpp"
 #include "Table.hpp"
+#include "LikePattern.hpp"
 
 void format(String& string);
 
-Vector<String> tokenize(const StringView& string);
+// the vector of tokens allocates from @arena if given
+Vector<String> tokenize(const StringView& string, Arena* arena = nullptr);
 
 void combine_keyword_tokens(Vector<String>& tokens);
 
@@ -16,11 +18,11 @@ Cell* parse_value_token(const StringView& token);
 
 DataType convert_string_to_data_type(const StringView& token);
 
-Vector<Column> parse_column_definitions_clause(const Vector<String>& tokens);
+Vector<Column> parse_column_definitions_clause(const VectorView<String>& tokens);
 
-Vector<Cell*> parse_row(const Vector<String>& tokens);
+Vector<Cell*> parse_row(const VectorView<String>& tokens);
 
-Vector<String> parse_select_clause(const Vector<String>& tokens);
+Vector<String> parse_select_clause(const VectorView<String>& tokens);
 
 bool is_relational_operator(const StringView& token);
 bool is_is_null_operator(const StringView& token);
@@ -31,9 +33,29 @@ bool is_operator(const StringView& token);
 
 uint8_t precedence(const StringView& op);
 
-// shunting yard algorithm
-Vector<String> convert_to_postfix(const Vector<String>& tokens);
+// shunting yard algorithm; the result and the stack of operators allocate from @arena if given
+Vector<String> convert_to_postfix(const VectorView<String>& tokens, Arena* arena = nullptr);
 
 Function<bool, Vector<Cell*>> parse_relational_condition(size_t column_pos, const StringView& right, const StringView& op);
 
-Function<bool, Vector<Cell*>> parse_is_null_condition(size_t column_pos, const StringView& op);
\ No newline at end of file
+Function<bool, Vector<Cell*>> parse_is_null_condition(size_t column_pos, const StringView& op);
+
+Function<bool, Vector<Cell*>> parse_is_like_condition(size_t column_pos, const StringView& right, const StringView& op);
+
+// @condition on column @column_pos of @table, answered up front for every value of the column's dictionary and then by the code of a row's cell;
+// cells without a code, or with one the dictionary got since, are left to @condition
+Function<bool, Vector<Cell*>> evaluate_on_codes(const AbstractTable* table, size_t column_pos, Function<bool, Vector<Cell*>>&& condition);
+
+bool is_value_token(const StringView& token);
+
+// splits a where clause on its top-level 'and' operators; a clause with a top-level 'or' is returned whole
+// the conjuncts are views of @tokens, which must outlive them
+Vector<VectorView<String>> split_conjuncts(const VectorView<String>& tokens);
+// the vector of tokens allocates from @arena if given
+Vector<String> combine_conjuncts(const Vector<VectorView<String>>& conjuncts, Arena* arena = nullptr);
+
+Vector<String> find_column_names(const VectorView<String>& tokens);
+
+// returns the table name shared by every column of the condition, or an empty string if the columns are unqualified or span several tables
+String find_qualifying_table_name(const VectorView<String>& tokens);
+Vector<String> unqualify_column_names(const VectorView<String>& tokens);
\ No newline at end of file
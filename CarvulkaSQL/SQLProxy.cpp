@@ -1,29 +1,93 @@
 #include "SQLProxy.hpp"
 #include "SQLParsingUtils.hpp"
 
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
 using namespace std;
 
 /* SQLResponse */
 
-SQLResponse::SQLResponse(const StringView& message) : m_selection(), m_message(message) {}
-SQLResponse::SQLResponse(String&& message) : m_selection(), m_message(move(message)) {}
-SQLResponse::SQLResponse(const Selection& selection, const StringView& message) : m_selection(selection), m_message(message) {}
-SQLResponse::SQLResponse(const Selection& selection, String&& message) : m_selection(selection), m_message(move(message)) {}
-SQLResponse::SQLResponse(Selection&& selection, const StringView& message) : m_selection(move(selection)), m_message(message) {}
-SQLResponse::SQLResponse(Selection&& selection, String&& message) : m_selection(move(selection)), m_message(move(message)) {}
+void SQLResponse::free()
+{
+    delete m_cursor;
+}
+
+SQLResponse::SQLResponse(const StringView& message) : m_cursor(nullptr), m_message(message) {}
+SQLResponse::SQLResponse(String&& message) : m_cursor(nullptr), m_message(move(message)) {}
+SQLResponse::SQLResponse(Selection&& selection, const StringView& message) : m_cursor(new SelectionCursor(move(selection))), m_message(message) {}
+SQLResponse::SQLResponse(Selection&& selection, String&& message) : m_cursor(new SelectionCursor(move(selection))), m_message(move(message)) {}
+SQLResponse::SQLResponse(Cursor* cursor, const StringView& message) : m_cursor(cursor), m_message(message) {}
+SQLResponse::SQLResponse(Cursor* cursor, String&& message) : m_cursor(cursor), m_message(move(message)) {}
+
+SQLResponse::SQLResponse(SQLResponse&& other) noexcept : m_cursor(other.m_cursor), m_message(move(other.m_message))
+{
+    other.m_cursor = nullptr;
+}
+SQLResponse::~SQLResponse() noexcept
+{
+    free();
+}
+SQLResponse& SQLResponse::operator = (SQLResponse&& other) noexcept
+{
+    if (this != &other)
+    {
+        free();
+        m_cursor = other.m_cursor;
+        m_message = move(other.m_message);
+        other.m_cursor = nullptr;
+    }
+    return *this;
+}
 
 const String& SQLResponse::message() const
 {
     return m_message;
 }
-const Selection& SQLResponse::selection() const
+Cursor& SQLResponse::cursor()
+{
+    return *m_cursor;
+}
+bool SQLResponse::has_selection() const
 {
-    return m_selection;
+    return m_cursor != nullptr;
+}
+bool SQLResponse::is_error() const
+{
+    // every failure is reported as a syntax error or a runtime error
+    return (m_message.size() >= 7 and StringView(m_message).slice(0, 7) == "syntax ") or (m_message.size() >= 8 and StringView(m_message).slice(0, 8) == "runtime ");
 }
 
 /* SQLProxy */
 
-SQLProxy::SQLProxy(Database& database) : database(database) {}
+SQLProxy::SQLProxy(Database& database) : database(database), m_transaction(nullptr), m_output_format(OutputFormat::TABLE), m_statement_arena() {}
+SQLProxy::~SQLProxy() noexcept
+{
+    // a transaction left open was never committed
+    if (m_transaction != nullptr)
+    {
+        database.roll_back_transaction(*m_transaction);
+        delete m_transaction;
+    }
+}
+
+SQLResponse SQLProxy::execute(const StringView& statement)
+{
+    // whatever the previous statement left in the arena died with it, a cursor it returned holds nothing from there
+    m_statement_arena.reset();
+    String input = statement;
+    format(input);
+    Vector<String> tokens = move(tokenize(input, &m_statement_arena));
+    combine_keyword_tokens(tokens);
+    return parse_and_execute_cmd(tokens);
+}
+
+OutputFormat SQLProxy::output_format() const
+{
+    return m_output_format;
+}
 
 void SQLProxy::run_console_interface()
 {
@@ -31,15 +95,29 @@ void SQLProxy::run_console_interface()
     String input;
     do
     {
-        cout << "csql> ";
+        // in the machine-readable formats only the rows go to the standard output, so that it can be piped into other tools
+        ostream& messages = m_output_format == OutputFormat::TABLE ? cout : cerr;
+        messages << "csql> ";
         cin.getline(buffer, BUFFER_SIZE, ';');
         input = buffer;
         format(input);
         if (input == "exit ") break;
-        Vector<String> tokens = move(tokenize(input));
-        combine_keyword_tokens(tokens);
-        SQLResponse response = parse_and_execute_cmd(tokens);
-        cout << "\n" << response.message() << "\n\n";
+        SQLResponse response = execute(input);
+        if (response.has_selection())
+        {
+            if (m_output_format == OutputFormat::TABLE)
+            {
+                cout << "\n";
+            }
+#ifdef _WIN32
+            // frames have to reach the standard output without their newline bytes translated
+            cout.flush();
+            _setmode(_fileno(stdout), m_output_format == OutputFormat::BINARY ? _O_BINARY : _O_TEXT);
+#endif
+            write_rows_to(cout, response.cursor(), m_output_format);
+        }
+        ostream& response_messages = m_output_format == OutputFormat::TABLE ? cout : cerr;
+        response_messages << "\n" << response.message() << "\n\n";
     } 
     while (true);
 }
@@ -48,8 +126,25 @@ SQLResponse SQLProxy::parse_and_execute_cmd(const Vector<String>& tokens)
 {
 
     if (tokens.is_empty()) return SQLResponse(String("syntax error: empty input"));
+    if (m_transaction != nullptr and is_disallowed_in_transaction(tokens[0])) return SQLResponse(String("runtime error: not allowed inside a transaction"));
 
-    if (tokens[0] == "list tables")
+    if (tokens[0] == "begin")
+    {
+        return parse_and_execute_begin_cmd(tokens);
+    }
+    else if (tokens[0] == "commit")
+    {
+        return parse_and_execute_commit_cmd(tokens);
+    }
+    else if (tokens[0] == "rollback")
+    {
+        return parse_and_execute_rollback_cmd(tokens);
+    }
+    else if (tokens[0] == "set")
+    {
+        return parse_and_execute_set_cmd(tokens);
+    }
+    else if (tokens[0] == "list tables")
     {
         return parse_and_execute_list_tables_cmd(tokens);
     }
@@ -73,6 +168,14 @@ SQLResponse SQLProxy::parse_and_execute_cmd(const Vector<String>& tokens)
     {
         return parse_and_execute_alter_table_cmd(tokens);
     }
+    else if (tokens[0] == "create index")
+    {
+        return parse_and_execute_create_index_cmd(tokens);
+    }
+    else if (tokens[0] == "drop index")
+    {
+        return parse_and_execute_drop_index_cmd(tokens);
+    }
     else if (tokens[0] == "select")
     {
         return parse_and_execute_select_cmd(tokens);
@@ -93,19 +196,100 @@ SQLResponse SQLProxy::parse_and_execute_cmd(const Vector<String>& tokens)
     {
         return parse_and_execute_truncate_table_cmd(tokens);
     }
+    else if (tokens[0] == "vacuum")
+    {
+        return parse_and_execute_vacuum_cmd(tokens);
+    }
+    else if (tokens[0] == "analyze")
+    {
+        return parse_and_execute_analyze_cmd(tokens);
+    }
+    else if (tokens[0] == "show statistics")
+    {
+        return parse_and_execute_show_statistics_cmd(tokens);
+    }
     else
     {
         return SQLResponse(String("syntax error: unrecognized token"));
     }
 }
 
+bool SQLProxy::is_disallowed_in_transaction(const StringView& command)
+{
+    return command == "save table" or command == "create table" or command == "drop table" or command == "rename table" or command == "alter table"
+        or command == "create index" or command == "drop index" or command == "truncate table" or command == "vacuum";
+}
+
+SQLResponse SQLProxy::parse_and_execute_begin_cmd(const Vector<String>& tokens)
+{
+    if (tokens.size() - 1 > 0) return SQLResponse(String("syntax error: unexpected token '").append(tokens[1]).append('\''));
+    if (m_transaction != nullptr) return SQLResponse(String("runtime error: a transaction is already open"));
+
+    try { m_transaction = new Transaction(move(database.begin_transaction())); }
+    catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
+    return SQLResponse(String("Began transaction successfully"));
+}
+
+SQLResponse SQLProxy::parse_and_execute_commit_cmd(const Vector<String>& tokens)
+{
+    if (tokens.size() - 1 > 0) return SQLResponse(String("syntax error: unexpected token '").append(tokens[1]).append('\''));
+    if (m_transaction == nullptr) return SQLResponse(String("runtime error: no transaction is open"));
+
+    // rolled back if it fails, so the transaction is over either way
+    Transaction* transaction = m_transaction;
+    m_transaction = nullptr;
+    try { database.commit_transaction(*transaction); }
+    catch (const exception& e)
+    {
+        delete transaction;
+        return SQLResponse(String("runtime error: ").append(e.what()));
+    }
+    delete transaction;
+    return SQLResponse(String("Committed transaction successfully"));
+}
+
+SQLResponse SQLProxy::parse_and_execute_rollback_cmd(const Vector<String>& tokens)
+{
+    if (tokens.size() - 1 > 0) return SQLResponse(String("syntax error: unexpected token '").append(tokens[1]).append('\''));
+    if (m_transaction == nullptr) return SQLResponse(String("runtime error: no transaction is open"));
+
+    database.roll_back_transaction(*m_transaction);
+    delete m_transaction;
+    m_transaction = nullptr;
+    return SQLResponse(String("Rolled back transaction successfully"));
+}
+
+// set output = table | csv | jsonl | binary
+SQLResponse SQLProxy::parse_and_execute_set_cmd(const Vector<String>& tokens)
+{
+    if (tokens.size() - 1 < 3) return SQLResponse(String("syntax error: invalid statement"));
+    if (tokens.size() - 1 > 3) return SQLResponse(String("syntax error: unexpected token '").append(tokens[4]).append('\''));
+    if (tokens[1] != "output") return SQLResponse(String("syntax error: unrecognized setting '").append(tokens[1]).append('\''));
+    if (tokens[2] != "=") return SQLResponse(String("syntax error: expected '=' after '").append(tokens[1]).append('\''));
+
+    OutputFormat output_format = convert_string_to_output_format(tokens[3]);
+    if (output_format == OutputFormat::INVALID) return SQLResponse(String("syntax error: unrecognized output format '").append(tokens[3]).append('\''));
+    m_output_format = output_format;
+    return SQLResponse(String("Set output to ").append(tokens[3]).append(" successfully"));
+}
+
 SQLResponse SQLProxy::parse_and_execute_list_tables_cmd(const Vector<String>& tokens)
 {
     if (tokens.size() - 1 > 0) return SQLResponse(String("syntax error: unexpected token '").append(tokens[1]).append('\''));
 
-    cout << "\n";
-    database.list_tables();
-    return SQLResponse(String("Listed tables in database successfully"));
+    // one column named after the database, with a row per table
+    Vector<String> table_names = move(database.list_tables());
+    if (table_names.is_empty()) return SQLResponse(Selection(), String("Listed tables in database successfully"));
+
+    Vector<Vector<Cell*>> rows;
+    rows.resize_capacity_to(table_names.size());
+    for (size_t i = 0; i < table_names.size(); i += 1)
+    {
+        rows.append({ new StringCell(move(table_names[i])) });
+    }
+    AnonymousTable tables_table({ Column(database.name(), DataType::STRING) }, move(rows));
+    Selection selection = Selection(tables_table, { "*" }, [](const Vector<Cell*>& row) -> bool { return true; });
+    return SQLResponse(move(selection), String("Listed tables in database successfully"));
 }
 
 SQLResponse SQLProxy::parse_and_execute_save_table_cmd(const Vector<String>& tokens)
@@ -113,8 +297,6 @@ SQLResponse SQLProxy::parse_and_execute_save_table_cmd(const Vector<String>& tok
     if (tokens.size() - 1 < 3 or tokens[2] != "to") return SQLResponse(String("syntax error: invalid statement"));
     if (tokens.size() - 1 > 3) return SQLResponse(String("syntax error: unexpected token '").append(tokens[4]).append("'"));
 
-    size_t table_pos = database.find_table_by_name(tokens[1]);
-
     char path[BUFFER_SIZE];
     size_t i = 0;
     while (i < tokens[3].size())
@@ -124,7 +306,7 @@ SQLResponse SQLProxy::parse_and_execute_save_table_cmd(const Vector<String>& tok
     }
     path[i] = '\0';
 
-    try { database.save_table(table_pos, path); }
+    try { database.save_table(tokens[1], path); }
     catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
     return SQLResponse(String("Table saved successfully"));
 }
@@ -134,10 +316,11 @@ SQLResponse SQLProxy::parse_and_execute_create_table_cmd(const Vector<String>& t
     if (tokens.size() - 1 < 2) return SQLResponse(String("syntax error: invalid statement"));
 
     Vector<Column> columns;
-    try { columns = move(parse_column_definitions_clause(tokens.slice(2, tokens.size()))); }
+    try { columns = move(parse_column_definitions_clause(tokens.view(2, tokens.size()))); }
     catch (const exception& e) { return SQLResponse(String("syntax error: ").append(e.what())); }
 
-    database.create_table(tokens[1], move(columns));
+    try { database.create_table(tokens[1], move(columns)); }
+    catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
     return SQLResponse(String("Created table '").append(tokens[1]).append("' successfully"));
 }
 
@@ -146,9 +329,7 @@ SQLResponse SQLProxy::parse_and_execute_drop_table_cmd(const Vector<String>& tok
     if (tokens.size() - 1 < 1) return SQLResponse(String("syntax error: invalid statement"));
     if (tokens.size() - 1 > 1) return SQLResponse(String("syntax error: unexpected token '").append(tokens[2]).append("'"));
 
-    size_t table_pos = database.find_table_by_name(tokens[1]);
-
-    try { database.drop_table(table_pos); }
+    try { database.drop_table(tokens[1]); }
     catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
     return SQLResponse(String("Dropped table '").append(tokens[1]).append("' successfully"));
 }
@@ -158,9 +339,7 @@ SQLResponse SQLProxy::parse_and_execute_rename_table_cmd(const Vector<String>& t
     if (tokens.size() - 1 < 3 or tokens[2] != "to") return SQLResponse(String("syntax error: invalid statement"));
     if (tokens.size() - 1 > 3) return SQLResponse(String("syntax error: unexpected token '").append(tokens[4]).append("'"));
 
-    size_t table_pos = database.find_table_by_name(tokens[1]);
-
-    try { database.rename_table(table_pos, tokens[3]); }
+    try { database.rename_table(tokens[1], tokens[3]); }
     catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
     return SQLResponse(String("Renamed table '").append(tokens[1]).append("' to '").append(tokens[3]).append("' successfully"));
 }
@@ -192,12 +371,10 @@ SQLResponse SQLProxy::parse_and_execute_add_column_cmd(const Vector<String>& tok
     if (tokens.size() - 1 < 4) return SQLResponse(String("syntax error: invalid statement"));
     if (tokens.size() - 1 > 4) return SQLResponse(String("syntax error: unexpected token '").append(tokens[5]).append("'"));
 
-    size_t table_pos = database.find_table_by_name(tokens[1]);
-
     DataType data_type = convert_string_to_data_type(tokens[4]);
     if (data_type == DataType::INVALID) return SQLResponse(String("syntax error: invalid data type"));
 
-    try { database.add_column_to_table(table_pos, Column(tokens[3], data_type)); }
+    try { database.add_column_to_table(tokens[1], Column(tokens[3], data_type)); }
     catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
     return SQLResponse(String("Added column '").append(tokens[3]).append("' to '").append(tokens[1]).append("' successfully"));
 }
@@ -207,10 +384,7 @@ SQLResponse SQLProxy::parse_and_execute_drop_column_cmd(const Vector<String>& to
     if (tokens.size() - 1 < 3) return SQLResponse(String("syntax error: invalid statement"));
     if (tokens.size() - 1 > 3) return SQLResponse(String("syntax error: unexpected token '").append(tokens[4]).append("'"));
 
-    size_t table_pos = database.find_table_by_name(tokens[1]);
-    size_t column_pos = database.tables()[table_pos].find_column_by_name(tokens[3]);
-
-    try { database.drop_column_from_table(table_pos, column_pos); }
+    try { database.drop_column_from_table(tokens[1], tokens[3]); }
     catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
     return SQLResponse(String("Dropped column '").append(tokens[3]).append("' from '").append(tokens[1]).append("' successfully"));
 }
@@ -220,26 +394,42 @@ SQLResponse SQLProxy::parse_and_execute_rename_column_cmd(const Vector<String>&
     if (tokens.size() - 1 < 5 or tokens[4] != "to")  return SQLResponse(String("syntax error: invalid statement"));
     if (tokens.size() - 1 > 5) return SQLResponse(String("syntax error: unexpected token '").append(tokens[6]).append("'"));
 
-    size_t table_pos = database.find_table_by_name(tokens[1]);
-    size_t column_pos = database.tables()[table_pos].find_column_by_name(tokens[3]);
-
-    try { database.rename_column_from_table(table_pos, column_pos, tokens[5]); }
+    try { database.rename_column_from_table(tokens[1], tokens[3], tokens[5]); }
     catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
     return SQLResponse(String("Renamed column '").append(tokens[3]).append("' to '").append(tokens[5]).append("' successfully"));
 }
 
+SQLResponse SQLProxy::parse_and_execute_create_index_cmd(const Vector<String>& tokens)
+{
+    if (tokens.size() - 1 < 5 or tokens[1] != "on" or tokens[3] != "(" or tokens[5] != ")") return SQLResponse(String("syntax error: invalid statement"));
+    if (tokens.size() - 1 > 5) return SQLResponse(String("syntax error: unexpected token '").append(tokens[6]).append("'"));
+
+    try { database.create_index_on_table(tokens[2], tokens[4]); }
+    catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
+    return SQLResponse(String("Created index on '").append(tokens[2]).append('.').append(tokens[4]).append("' successfully"));
+}
+
+SQLResponse SQLProxy::parse_and_execute_drop_index_cmd(const Vector<String>& tokens)
+{
+    if (tokens.size() - 1 < 5 or tokens[1] != "on" or tokens[3] != "(" or tokens[5] != ")") return SQLResponse(String("syntax error: invalid statement"));
+    if (tokens.size() - 1 > 5) return SQLResponse(String("syntax error: unexpected token '").append(tokens[6]).append("'"));
+
+    try { database.drop_index_from_table(tokens[2], tokens[4]); }
+    catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
+    return SQLResponse(String("Dropped index on '").append(tokens[2]).append('.').append(tokens[4]).append("' successfully"));
+}
+
 Vector<Cell*> SQLProxy::eval_partial_row(Vector<Cell*>& partial_row, size_t table_pos, const Vector<String>& column_names)
 {
-    Vector<Cell*> row(database.tables()[table_pos].columns().size(), nullptr);
-    for (size_t i = 0; i < database.tables()[table_pos].columns().size(); i += 1)
+    const Table& table = database.tables()[table_pos];
+    Vector<Cell*> row(table.columns().size(), nullptr);
+    for (size_t i = 0; i < column_names.size(); i += 1)
     {
-        for (size_t j = 0; j < column_names.size(); j += 1)
+        // a column named twice takes the first value given for it
+        size_t column_pos = table.find_column_by_name(column_names[i]);
+        if (column_pos != -1 and row[column_pos] == nullptr)
         {
-            if (database.tables()[table_pos].columns()[i].name() == column_names[j])
-            {
-                row[i] = partial_row[j]->clone();
-                break;
-            }
+            row[column_pos] = partial_row[i]->clone();
         }
     }
     Table::free_row(partial_row);
@@ -252,30 +442,27 @@ SQLResponse SQLProxy::parse_and_execute_insert_cmd(const Vector<String>& tokens)
     if (values_kw_pos == -1 or tokens.size() - 1 < values_kw_pos + 1) return SQLResponse(String("syntax error: invalid statement"));
 
     Vector<String> column_names;
-    try { column_names = move(parse_select_clause(tokens.slice(2, values_kw_pos))); }
+    try { column_names = move(parse_select_clause(tokens.view(2, values_kw_pos))); }
     catch (const exception& e) { return SQLResponse(String("syntax error: ").append(e.what())); }
 
     Vector<Cell*> row;
-    try { row = move(parse_row(tokens.slice(values_kw_pos + 1, tokens.size()))); }
+    try { row = move(parse_row(tokens.view(values_kw_pos + 1, tokens.size()))); }
     catch (const exception& e)
     { 
         Table::free_row(row);
         return SQLResponse(String("syntax error: ").append(e.what()));
     }
 
-    size_t table_pos = database.find_table_by_name(tokens[1]);
-
-    if (not column_names.is_empty())
+    try
     {
-        if (table_pos == -1)
+        WriteGuard guard(database, m_transaction, tokens[1]);
+        if (not column_names.is_empty())
         {
-            Table::free_row(row);
-            return SQLResponse(String("runtime error: table pos out of bounds"));
+            row = move(eval_partial_row(row, guard.table_pos(), column_names));
         }
-        row = move(eval_partial_row(row, table_pos, column_names));
+        database.insert_into_table(guard, move(row));
+        guard.commit();
     }
-
-    try { database.insert_into_table(table_pos, move(row)); }
     catch (const exception& e)
     {
         Table::free_row(row);
@@ -288,25 +475,26 @@ SQLResponse SQLProxy::parse_and_execute_update_cmd(const Vector<String>& tokens)
 {
     if (tokens.size() - 1 < 5 or tokens[2] != "set" or tokens[4] != "=") return SQLResponse(String("syntax error: invalid statement"));
 
-    size_t table_pos = database.find_table_by_name(tokens[1]);
-    size_t column_pos = database.tables()[table_pos].find_column_by_name(tokens[3]);
-
     Cell* value = nullptr;
     try { value = parse_value_token(tokens[5]); }
     catch (const exception& e) { return SQLResponse(String("syntax error: ").append(e.what())); }
 
-    Function<bool, Vector<Cell*>> condition = [](const Vector<Cell*>& row) -> bool { return true; };
-    size_t where_kw_pos = tokens.find("where");
-    if (where_kw_pos != -1)
+    // the table stays latched from looking up its columns until the rows are updated
+    try
     {
-        try { condition = move(eval_where_clause(&database.tables().at(table_pos), tokens.slice(where_kw_pos + 1, tokens.size()))); }
-        catch (const exception& e)
+        WriteGuard guard(database, m_transaction, tokens[1]);
+        const Table& table = database.tables()[guard.table_pos()];
+        size_t column_pos = table.find_column_by_name(tokens[3]);
+
+        Function<bool, Vector<Cell*>> condition = [](const Vector<Cell*>& row) -> bool { return true; };
+        size_t where_kw_pos = tokens.find("where");
+        if (where_kw_pos != -1)
         {
-            delete value;
-            return SQLResponse(String("runtime error: ").append(e.what()));
+            condition = move(eval_where_clause(&table, tokens.view(where_kw_pos + 1, tokens.size())));
         }
+        database.update_table(guard, column_pos, value, condition);
+        guard.commit();
     }
-    try { database.update_table(table_pos, column_pos, value, condition); }
     catch (const exception& e)
     {
         delete value;
@@ -320,16 +508,18 @@ SQLResponse SQLProxy::parse_and_execute_delete_from_cmd(const Vector<String>& to
 {
     if (tokens.size() - 1 < 1) return SQLResponse(String("syntax error: invalid statement"));
 
-    size_t table_pos = database.find_table_by_name(tokens[1]);
-
-    Function<bool, Vector<Cell*>> condition = [](const Vector<Cell*>& row) -> bool { return true; };
-    size_t where_kw_pos = tokens.find("where");
-    if (where_kw_pos != -1)
+    try
     {
-        try { condition = move(eval_where_clause(&database.tables().at(table_pos), tokens.slice(where_kw_pos + 1, tokens.size()))); }
-        catch (const exception & e) { return SQLResponse(String("runtime error: ").append(e.what())); }
+        WriteGuard guard(database, m_transaction, tokens[1]);
+        Function<bool, Vector<Cell*>> condition = [](const Vector<Cell*>& row) -> bool { return true; };
+        size_t where_kw_pos = tokens.find("where");
+        if (where_kw_pos != -1)
+        {
+            condition = move(eval_where_clause(&database.tables()[guard.table_pos()], tokens.view(where_kw_pos + 1, tokens.size())));
+        }
+        database.delete_from_table(guard, condition);
+        guard.commit();
     }
-    try { database.delete_from_table(table_pos, condition); }
     catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
     return SQLResponse(String("Deleted rows from '").append(tokens[1]).append("' successfully"));
 }
@@ -339,16 +529,282 @@ SQLResponse SQLProxy::parse_and_execute_truncate_table_cmd(const Vector<String>&
     if (tokens.size() - 1 < 1) return SQLResponse(String("syntax error: invalid statement"));
     if (tokens.size() - 1 > 1) return SQLResponse(String("syntax error: unexpected token '").append(tokens[2]).append("'"));
 
-    size_t table_pos = database.find_table_by_name(tokens[1]);
-
-    try { database.truncate_table(table_pos); }
+    try { database.truncate_table(tokens[1]); }
     catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
     return SQLResponse(String("Updated rows from '").append(tokens[1]).append("' successfully"));
 }
 
-AnonymousTable* SQLProxy::eval_join_clause(Table* primary_table, const Vector<String>& tokens)
+SQLResponse SQLProxy::parse_and_execute_vacuum_cmd(const Vector<String>& tokens)
+{
+    if (tokens.size() - 1 > 1) return SQLResponse(String("syntax error: unexpected token '").append(tokens[2]).append("'"));
+
+    if (tokens.size() - 1 == 0)
+    {
+        try
+        {
+            Vector<String> table_names = move(database.list_tables());
+            for (size_t i = 0; i < table_names.size(); i += 1)
+            {
+                database.vacuum_table(table_names[i]);
+            }
+        }
+        catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
+        return SQLResponse(String("Vacuumed tables in database successfully"));
+    }
+
+    try { database.vacuum_table(tokens[1]); }
+    catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
+    return SQLResponse(String("Vacuumed table '").append(tokens[1]).append("' successfully"));
+}
+
+SQLResponse SQLProxy::parse_and_execute_analyze_cmd(const Vector<String>& tokens)
 {
-    AnonymousTable lhs_table = AnonymousTable(*primary_table);
+    if (tokens.size() - 1 > 1) return SQLResponse(String("syntax error: unexpected token '").append(tokens[2]).append("'"));
+
+    if (tokens.size() - 1 == 0)
+    {
+        Vector<String> table_names = move(database.list_tables());
+        try
+        {
+            for (size_t i = 0; i < table_names.size(); i += 1)
+            {
+                database.analyze_table(table_names[i]);
+            }
+        }
+        catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
+        return SQLResponse(String("Analyzed tables in database successfully"));
+    }
+
+    try { database.analyze_table(tokens[1]); }
+    catch (const exception& e) { return SQLResponse(String("runtime error: ").append(e.what())); }
+    return SQLResponse(String("Analyzed table '").append(tokens[1]).append("' successfully"));
+}
+
+// renders @values as a comma separated list, each followed by its frequency if there are any
+static String render_values(const Vector<Cell*>& values, const Vector<double>& frequencies)
+{
+    String rendered;
+    for (size_t i = 0; i < values.size(); i += 1)
+    {
+        if (i != 0)
+        {
+            rendered.append(", ");
+        }
+        if (values[i]->data_type == DataType::STRING)
+        {
+            rendered.append('\'').append(static_cast<const StringCell*>(values[i])->value).append('\'');
+        }
+        else
+        {
+            rendered.append(values[i]->convert_to_string());
+        }
+        if (not frequencies.is_empty())
+        {
+            rendered.append(": ").append(RealCell(frequencies[i]).convert_to_string());
+        }
+    }
+    return rendered;
+}
+
+SQLResponse SQLProxy::parse_and_execute_show_statistics_cmd(const Vector<String>& tokens)
+{
+    if (tokens.size() - 1 < 1) return SQLResponse(String("syntax error: invalid statement"));
+    if (tokens.size() - 1 > 1) return SQLResponse(String("syntax error: unexpected token '").append(tokens[2]).append("'"));
+
+    shared_lock<Latch> catalog_lock = database.latch_catalog();
+    size_t table_pos = database.find_table_by_name(tokens[1]);
+    if (table_pos == -1) return SQLResponse(String("runtime error: table not found"));
+
+    SnapshotGuard guard(database, move(catalog_lock), { table_pos });
+    const Table& table = database.tables()[table_pos];
+    TableStatistics statistics = table.statistics();
+    TableAnalysis analysis = table.analysis();
+
+    Vector<Column> columns = {
+        Column(String("column"), DataType::STRING), Column(String("null_fraction"), DataType::REAL), Column(String("distinct_count"), DataType::INTEGER), Column(String("min"), DataType::STRING),
+        Column(String("max"), DataType::STRING), Column(String("most_common_values"), DataType::STRING), Column(String("histogram_bounds"), DataType::STRING)
+    };
+    Vector<Vector<Cell*>> rows;
+    for (size_t j = 0; j < table.columns().size(); j += 1)
+    {
+        const ColumnStatistics& column_statistics = statistics.columns()[j];
+        Vector<Cell*> row(columns.size(), nullptr);
+        row[0] = new StringCell(table.columns()[j].name());
+        row[1] = new RealCell(statistics.null_fraction(j));
+        row[2] = new IntegerCell(static_cast<Integer>(statistics.distinct_count(j) + 0.5));
+        if (column_statistics.min() != nullptr)
+        {
+            row[3] = new StringCell(column_statistics.min()->convert_to_string());
+            row[4] = new StringCell(column_statistics.max()->convert_to_string());
+        }
+        if (not analysis.is_empty())
+        {
+            const ColumnDistribution& distribution = analysis.columns()[j];
+            if (not distribution.most_common_values().is_empty())
+            {
+                row[5] = new StringCell(render_values(distribution.most_common_values(), distribution.most_common_frequencies()));
+            }
+            if (not distribution.histogram_bounds().is_empty())
+            {
+                row[6] = new StringCell(render_values(distribution.histogram_bounds(), Vector<double>()));
+            }
+        }
+        rows.append(move(row));
+    }
+
+    AnonymousTable statistics_table(move(columns), move(rows));
+    Selection selection = Selection(statistics_table, { "*" }, [](const Vector<Cell*>& row) -> bool { return true; });
+
+    String message = String("Retrieved statistics of '").append(tokens[1]).append("' successfully");
+    if (analysis.is_empty())
+    {
+        message.append(" (not analyzed; ");
+    }
+    else
+    {
+        message.append(" (analyzed ").append(IntegerCell(static_cast<Integer>(analysis.sample_size())).convert_to_string()).append(" of ")
+            .append(IntegerCell(static_cast<Integer>(analysis.row_count())).convert_to_string()).append(" rows; ");
+    }
+    // versions not purged yet count as well
+    const CellPool& cells = table.cells();
+    append_integer_to(message, static_cast<Integer>(cells.cell_count()));
+    message.append(" cells taking ");
+    append_integer_to(message, static_cast<Integer>(cells.used_bytes()));
+    message.append(" of ");
+    append_integer_to(message, static_cast<Integer>(cells.reserved_bytes()));
+    message.append(" bytes reserved)");
+    return SQLResponse(move(selection), move(message));
+}
+
+void SQLProxy::order_conjuncts_by_selectivity(const Table& table, Vector<VectorView<String>>& conjuncts) const
+{
+    // only 'column op value' and 'column is null' can be estimated; anything else goes last, in its original order
+    Vector<double> selectivities;
+    for (size_t i = 0; i < conjuncts.size(); i += 1)
+    {
+        const VectorView<String>& conjunct = conjuncts[i];
+        double selectivity = 2.0;
+        if (conjunct.size() == 3 and is_relational_operator(conjunct[1]) and is_value_token(conjunct[2]))
+        {
+            size_t column_pos = table.find_column_by_name(conjunct[0]);
+            Cell* value = nullptr;
+            if (column_pos != -1)
+            {
+                try { value = parse_value_token(conjunct[2]); }
+                catch (const exception& e) { column_pos = -1; }
+            }
+            if (column_pos != -1)
+            {
+                selectivity = table.estimate_selectivity(column_pos, conjunct[1], value);
+            }
+            delete value;
+        }
+        else if (conjunct.size() == 2 and is_is_null_operator(conjunct[1]))
+        {
+            size_t column_pos = table.find_column_by_name(conjunct[0]);
+            if (column_pos != -1)
+            {
+                selectivity = table.estimate_selectivity(column_pos, conjunct[1], nullptr);
+            }
+        }
+        selectivities.append(selectivity);
+    }
+
+    // insertion sort keeps equally selective conjuncts in their original order
+    for (size_t i = 1; i < conjuncts.size(); i += 1)
+    {
+        size_t j = i;
+        while (j > 0 and selectivities[j - 1] > selectivities[j])
+        {
+            swap(selectivities[j - 1], selectivities[j]);
+            swap(conjuncts[j - 1], conjuncts[j]);
+            j -= 1;
+        }
+    }
+}
+
+bool SQLProxy::find_index_candidates(const Table& table, const Vector<VectorView<String>>& conjuncts, const Snapshot& snapshot, Vector<size_t>& row_positions) const
+{
+    // every conjunct must hold, so any single indexed one bounds the result; the one with the fewest candidates is used
+    bool is_narrowed = false;
+    for (size_t i = 0; i < conjuncts.size(); i += 1)
+    {
+        const VectorView<String>& conjunct = conjuncts[i];
+        if (conjunct.size() != 3 or not is_is_like_operator(conjunct[1]) or conjunct[2].size() < 2 or conjunct[2].front() != '\'' or conjunct[2].back() != '\'') continue;
+
+        size_t column_pos = table.find_column_by_name(conjunct[0]);
+        if (column_pos == -1) continue;
+
+        Vector<RowId> candidate_row_ids;
+        if (not table.find_trigram_candidates(column_pos, StringView(conjunct[2]).slice(1, conjunct[2].size() - 1), candidate_row_ids)) continue;
+        if (not is_narrowed or candidate_row_ids.size() < row_positions.size())
+        {
+            // the index holds every version, the ones the snapshot can't see are left out here
+            row_positions = move(table.find_visible_rows_by_ids(candidate_row_ids, snapshot));
+            is_narrowed = true;
+        }
+    }
+    return is_narrowed;
+}
+
+JoinSource SQLProxy::scan_table(size_t table_pos, const Vector<size_t>& joined_table_positions, Vector<VectorView<String>>& where_conjuncts, const Snapshot& snapshot)
+{
+    const Table& table = database.tables()[table_pos];
+
+    // a table joined more than once can't tell its instances apart by name, so its predicates stay above the join
+    size_t join_count = 0;
+    for (size_t i = 0; i < joined_table_positions.size(); i += 1)
+    {
+        if (joined_table_positions[i] == table_pos)
+        {
+            join_count += 1;
+        }
+    }
+
+    // the pushed down conjuncts are views of their unqualified tokens, which are kept here until the scan is done
+    Vector<Vector<String>> unqualified_conjuncts(&m_statement_arena);
+    for (size_t i = 0; join_count == 1 and i < where_conjuncts.size(); i += 1)
+    {
+        if (find_qualifying_table_name(where_conjuncts[i]) == table.name())
+        {
+            unqualified_conjuncts.append(move(unqualify_column_names(where_conjuncts[i])));
+            where_conjuncts.erase(i);
+            i -= 1;
+        }
+    }
+    Vector<VectorView<String>> pushed_down_conjuncts(&m_statement_arena);
+    for (size_t i = 0; i < unqualified_conjuncts.size(); i += 1)
+    {
+        pushed_down_conjuncts.append(unqualified_conjuncts[i]);
+    }
+
+    Function<bool, Vector<Cell*>> condition = [](const Vector<Cell*>& row) -> bool { return true; };
+    if (not pushed_down_conjuncts.is_empty())
+    {
+        order_conjuncts_by_selectivity(table, pushed_down_conjuncts);
+        condition = move(eval_where_clause(&table, combine_conjuncts(pushed_down_conjuncts, &m_statement_arena)));
+    }
+
+    // the index only narrows the candidates, the condition still verifies each of them
+    Vector<size_t> candidate_row_positions;
+    if (not find_index_candidates(table, pushed_down_conjuncts, snapshot, candidate_row_positions))
+    {
+        candidate_row_positions = move(table.find_visible_rows(snapshot));
+    }
+    Vector<size_t> row_positions;
+    for (size_t i = 0; i < candidate_row_positions.size(); i += 1)
+    {
+        if (condition(table.row(candidate_row_positions[i])))
+        {
+            row_positions.append(candidate_row_positions[i]);
+        }
+    }
+    return JoinSource(&table, move(row_positions));
+}
+
+Vector<size_t> SQLProxy::resolve_joined_tables(size_t primary_table_pos, const VectorView<String>& tokens) const
+{
+    Vector<size_t> joined_table_positions = { primary_table_pos };
     size_t curr_pos = 0;
     while (curr_pos < tokens.size())
     {
@@ -360,20 +816,70 @@ AnonymousTable* SQLProxy::eval_join_clause(Table* primary_table, const Vector<St
         size_t secondary_table_pos = database.find_table_by_name(tokens[curr_pos]);
         if (secondary_table_pos == -1) throw exception("table not found");
 
-        AnonymousTable rhs_table = AnonymousTable(database.tables()[secondary_table_pos]);
-        try { lhs_table = move(AnonymousTable::join(lhs_table, rhs_table, tokens[curr_pos + 2], tokens[curr_pos + 4])); }
-        catch (const exception& e) { throw e; }
+        joined_table_positions.append(secondary_table_pos);
         curr_pos = next_join_kw_pos + 1;
     }
-    delete primary_table;
-    return new AnonymousTable(lhs_table);
+    if (joined_table_positions.size() > 64) throw exception("too many joined tables");
+    return joined_table_positions;
 }
 
-Function<bool, Vector<Cell*>> SQLProxy::eval_where_clause(const AbstractTable* table, const Vector<String>& tokens)
+AnonymousTable* SQLProxy::eval_join_clause(const Vector<size_t>& joined_table_positions, const VectorView<String>& tokens, Vector<VectorView<String>>& where_conjuncts, const Vector<String>& referenced_column_names, const Snapshot& snapshot)
 {
-    Vector<String> postfix_tokens = move(convert_to_postfix(tokens));
-    Vector<String> stack;
-    Vector<Function<bool, Vector<Cell*>>> conditions_stack;
+    // every joined table is resolved up front so that single-table predicates can be pushed into the scans below
+    Vector<JoinSource> sources;
+    for (size_t i = 0; i < joined_table_positions.size(); i += 1)
+    {
+        sources.append(move(scan_table(joined_table_positions[i], joined_table_positions, where_conjuncts, snapshot)));
+    }
+
+    // as written, every join condition relates the joined table to one of the tables before it
+    Vector<JoinCondition> conditions;
+    size_t curr_pos = 0;
+    for (size_t i = 1; i < joined_table_positions.size(); i += 1)
+    {
+        size_t next_join_kw_pos = tokens.find_in_interval("join", curr_pos, tokens.size());
+        next_join_kw_pos = next_join_kw_pos != -1 ? next_join_kw_pos : tokens.size();
+
+        JoinCondition condition = resolve_join_condition(sources, tokens[curr_pos + 2], tokens[curr_pos + 4]);
+        if (max(condition.lhs_source_pos, condition.rhs_source_pos) != i or condition.lhs_source_pos == condition.rhs_source_pos) throw exception("invalid match condition");
+        conditions.append(condition);
+        curr_pos = next_join_kw_pos + 1;
+    }
+
+    // the tables are joined in the order with the smallest estimated intermediate results, not necessarily the written one
+    Vector<size_t> join_order = find_join_order(sources, conditions);
+    JoinedRows joined_rows(move(sources), join_order[0]);
+    uint64_t joined_source_set = uint64_t(1) << join_order[0];
+    for (size_t i = 1; i < join_order.size(); i += 1)
+    {
+        Vector<JoinCondition> applicable_conditions;
+        for (size_t j = 0; j < conditions.size(); j += 1)
+        {
+            if ((conditions[j].lhs_source_pos == join_order[i] and (joined_source_set & (uint64_t(1) << conditions[j].rhs_source_pos)))
+                or (conditions[j].rhs_source_pos == join_order[i] and (joined_source_set & (uint64_t(1) << conditions[j].lhs_source_pos))))
+            {
+                applicable_conditions.append(conditions[j]);
+            }
+        }
+        joined_rows.join(join_order[i], applicable_conditions);
+        joined_source_set |= uint64_t(1) << join_order[i];
+    }
+
+    // the predicates left above the join need their columns materialized as well
+    Vector<String> materialized_column_names = referenced_column_names;
+    for (size_t i = 0; i < where_conjuncts.size(); i += 1)
+    {
+        materialized_column_names.append(move(find_column_names(where_conjuncts[i])));
+    }
+    return new AnonymousTable(joined_rows.materialize(materialized_column_names));
+}
+
+Function<bool, Vector<Cell*>> SQLProxy::eval_where_clause(const AbstractTable* table, const VectorView<String>& tokens)
+{
+    Vector<String> postfix_tokens = move(convert_to_postfix(tokens, &m_statement_arena));
+    Vector<String> stack(&m_statement_arena);
+    // the conditions themselves are kept by the cursor, so only the stack comes from the arena
+    Vector<Function<bool, Vector<Cell*>>> conditions_stack(&m_statement_arena);
     for (size_t i = 0; i < postfix_tokens.size(); i += 1)
     {
         const String& token = postfix_tokens[i];
@@ -385,7 +891,17 @@ Function<bool, Vector<Cell*>> SQLProxy::eval_where_clause(const AbstractTable* t
             stack.pop();
             size_t column_pos = table->find_column_by_name(left);
             if (column_pos == -1) throw exception("column not found");
-            conditions_stack.append(parse_relational_condition(column_pos, right, token));
+            conditions_stack.append(evaluate_on_codes(table, column_pos, parse_relational_condition(column_pos, right, token)));
+        }
+        else if (is_is_like_operator(token))
+        {
+            String right = stack.back();
+            stack.pop();
+            String left = stack.back();
+            stack.pop();
+            size_t column_pos = table->find_column_by_name(left);
+            if (column_pos == -1) throw exception("column not found");
+            conditions_stack.append(evaluate_on_codes(table, column_pos, parse_is_like_condition(column_pos, right, token)));
         }
         else if (is_is_null_operator(token))
         {
@@ -397,24 +913,25 @@ Function<bool, Vector<Cell*>> SQLProxy::eval_where_clause(const AbstractTable* t
         }
         else if (is_binary_logic_operator(token))
         {
-            Function<bool, Vector<Cell*>> right = conditions_stack.back();
+            // the operands are taken over by the condition combining them, not copied
+            Function<bool, Vector<Cell*>> right = move(conditions_stack.back());
             conditions_stack.pop();
-            Function<bool, Vector<Cell*>> left = conditions_stack.back();
+            Function<bool, Vector<Cell*>> left = move(conditions_stack.back());
             conditions_stack.pop();
             if (token == "and")
             {
-                conditions_stack.append([left, right](const Vector<Cell*>& row) -> bool { return left(row) and right(row); });
+                conditions_stack.append([left = move(left), right = move(right)](const Vector<Cell*>& row) -> bool { return left(row) and right(row); });
             }
             else if (token == "or")
             {
-                conditions_stack.append([left, right](const Vector<Cell*>& row) -> bool { return left(row) or right(row); });
+                conditions_stack.append([left = move(left), right = move(right)](const Vector<Cell*>& row) -> bool { return left(row) or right(row); });
             }
         }
         else if (is_unary_logic_operator(token))
         {
-            Function<bool, Vector<Cell*>> top = conditions_stack.back();
+            Function<bool, Vector<Cell*>> top = move(conditions_stack.back());
             conditions_stack.pop();
-            conditions_stack.append([top](const Vector<Cell*>& row) -> bool { return not top(row); });
+            conditions_stack.append([top = move(top)](const Vector<Cell*>& row) -> bool { return not top(row); });
         }
         else
         {
@@ -422,7 +939,7 @@ Function<bool, Vector<Cell*>> SQLProxy::eval_where_clause(const AbstractTable* t
         }
     }
     if (conditions_stack.size() != 1 or not stack.is_empty()) throw exception("invalid where clause");
-    return conditions_stack.back();
+    return move(conditions_stack.back());
 }
 
 SQLResponse SQLProxy::parse_and_execute_select_cmd(const Vector<String>& tokens)
@@ -431,9 +948,11 @@ SQLResponse SQLProxy::parse_and_execute_select_cmd(const Vector<String>& tokens)
     if (from_kw_pos == -1) return SQLResponse("syntax error: invalid statement");
 
     Vector<String> column_names;
-    try { column_names = move(parse_select_clause(tokens.slice(1, from_kw_pos))); }
+    try { column_names = move(parse_select_clause(tokens.view(1, from_kw_pos))); }
     catch (const exception& e) { return SQLResponse(String("syntax error: ").append(e.what())); }
 
+    // the tables are looked up with the catalog latched, which the snapshot guard keeps until the statement is done with them
+    shared_lock<Latch> catalog_lock = database.latch_catalog();
     size_t table_pos = database.find_table_by_name(tokens[from_kw_pos + 1]);
     if (table_pos == -1) return SQLResponse(String("runtime error: table pos out of bounds"));
 
@@ -441,43 +960,92 @@ SQLResponse SQLProxy::parse_and_execute_select_cmd(const Vector<String>& tokens)
     size_t where_kw_pos = tokens.find("where");
     size_t order_by_kw_pos = tokens.find("order by");
 
-    AbstractTable* table = new Table(database.tables()[table_pos]);
+    VectorView<String> where_tokens;
+    if (where_kw_pos != -1)
+    {
+        size_t upper_bound = order_by_kw_pos != -1 ? order_by_kw_pos : tokens.size();
+        where_tokens = tokens.view(where_kw_pos + 1, upper_bound);
+    }
+
+    size_t join_upper_bound = where_kw_pos != -1 ? where_kw_pos : order_by_kw_pos != -1 ? order_by_kw_pos : tokens.size();
+    Vector<size_t> table_positions = { table_pos };
     if (join_kw_pos != -1)
     {
-        if (join_kw_pos > from_kw_pos + 2)
-        {
-            delete table;
-            return SQLResponse(String("syntax error: unexpected token before 'join' keyword"));
-        }
-        size_t upper_bound = where_kw_pos != -1 ? where_kw_pos : order_by_kw_pos != -1 ? order_by_kw_pos : tokens.size();
-        try { table = move(eval_join_clause(static_cast<Table*>(table), tokens.slice(join_kw_pos + 1, upper_bound))); }
-        catch (const exception& e)
+        if (join_kw_pos > from_kw_pos + 2) return SQLResponse(String("syntax error: unexpected token before 'join' keyword"));
+
+        try { table_positions = move(resolve_joined_tables(table_pos, tokens.view(join_kw_pos + 1, join_upper_bound))); }
+        catch (const exception& e) { return SQLResponse(String("syntax or runtime error: ").append(e.what())); }
+    }
+
+    // a join is materialized into a table of its own, a single table is selected from in place, among the rows the snapshot can see
+    SnapshotGuard guard(database, move(catalog_lock), table_positions, m_transaction);
+    AnonymousTable* joined_table = nullptr;
+    bool is_index_scan = false;
+    Vector<size_t> candidate_row_positions;
+    const AbstractTable* table = &database.tables()[table_pos];
+    // the conjuncts left to filter the rows, combined again; where_tokens ends up a view of them
+    Vector<String> filtering_tokens(&m_statement_arena);
+    if (join_kw_pos != -1)
+    {
+        Vector<VectorView<String>> where_conjuncts(&m_statement_arena);
+        try { where_conjuncts = move(split_conjuncts(where_tokens)); }
+        catch (const exception& e) { return SQLResponse(String("syntax error: ").append(e.what())); }
+
+        Vector<String> referenced_column_names = column_names;
+        if (order_by_kw_pos != -1 and order_by_kw_pos + 1 < tokens.size())
         {
-            delete table;
-            return SQLResponse(String("syntax or runtime error: ").append(e.what()));
+            referenced_column_names.append(tokens[order_by_kw_pos + 1]);
         }
+
+        try { joined_table = eval_join_clause(table_positions, tokens.view(join_kw_pos + 1, join_upper_bound), where_conjuncts, referenced_column_names, guard.snapshot()); }
+        catch (const exception& e) { return SQLResponse(String("syntax or runtime error: ").append(e.what())); }
+        table = joined_table;
+
+        // only the predicates spanning several tables are left to filter the joined rows
+        filtering_tokens = move(combine_conjuncts(where_conjuncts, &m_statement_arena));
+        where_tokens = filtering_tokens;
+    }
+    else if (not where_tokens.is_empty())
+    {
+        Vector<VectorView<String>> where_conjuncts(&m_statement_arena);
+        try { where_conjuncts = move(split_conjuncts(where_tokens)); }
+        catch (const exception& e) { return SQLResponse(String("syntax error: ").append(e.what())); }
+
+        order_conjuncts_by_selectivity(database.tables()[table_pos], where_conjuncts);
+        is_index_scan = find_index_candidates(database.tables()[table_pos], where_conjuncts, guard.snapshot(), candidate_row_positions);
+        filtering_tokens = move(combine_conjuncts(where_conjuncts, &m_statement_arena));
+        where_tokens = filtering_tokens;
     }
 
     Function<bool, Vector<Cell*>> condition = [](const Vector<Cell*>& row) -> bool { return true; };
-    if (where_kw_pos != -1)
+    if (not where_tokens.is_empty())
     {
-        size_t upper_bound = order_by_kw_pos != -1 ? order_by_kw_pos : tokens.size();
-        try { condition = move(eval_where_clause(table, tokens.slice(where_kw_pos + 1, upper_bound))); }
+        try { condition = move(eval_where_clause(table, where_tokens)); }
         catch (const exception& e)
         {
-            delete table;
+            delete joined_table;
             return SQLResponse(String("runtime error: ").append(e.what()));
         }
     }
 
     if (join_kw_pos == -1 and where_kw_pos == -1 and order_by_kw_pos == -1 and tokens.size() - 1 > from_kw_pos + 1)
     {
-        delete table;
         return SQLResponse(String("syntax error: unexpected token '").append(tokens[from_kw_pos + 2]).append("'"));
     }
 
-    Selection selection = Selection(*table, column_names, condition);
-    delete table;
+    // rows of a single table that need no ordering are read as they are fetched, the cursor keeping the statement's snapshot until then
+    if (joined_table == nullptr and order_by_kw_pos == -1)
+    {
+        TableScanCursor* cursor = new TableScanCursor(move(guard), database.tables()[table_pos], column_names, move(condition), is_index_scan, move(candidate_row_positions));
+        return SQLResponse(cursor, String("Retrieved data from '").append(tokens[from_kw_pos + 1]).append("' successfully"));
+    }
+
+    if (joined_table == nullptr and not is_index_scan)
+    {
+        candidate_row_positions = move(database.tables()[table_pos].find_visible_rows(guard.snapshot()));
+    }
+    Selection selection = joined_table == nullptr ? Selection(*table, column_names, candidate_row_positions, condition) : Selection(*table, column_names, condition);
+    delete joined_table;
 
     if (order_by_kw_pos != -1)
     {
@@ -504,7 +1072,5 @@ SQLResponse SQLProxy::parse_and_execute_select_cmd(const Vector<String>& tokens)
             }
         }
     }
-    cout << "\n";
-    selection.print();
     return SQLResponse(move(selection), String("Retrieved data from '").append(tokens[from_kw_pos + 1]).append("' successfully"));
 }
\ No newline at end of file
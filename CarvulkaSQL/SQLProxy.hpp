@@ -2,22 +2,38 @@
 
 #include "Database.hpp"
 #include "Selection.hpp"
+#include "Cursor.hpp"
+#include "OutputFormat.hpp"
+#include "Join.hpp"
 
 class SQLResponse
 {
 private:
-    Selection m_selection;
+    // nullptr for the statements that only report what they did
+    Cursor* m_cursor;
     String m_message;
+private:
+    void free();
 public:
     SQLResponse(const StringView& message);
     SQLResponse(String&& message);
-    SQLResponse(const Selection& selection, const StringView& message);
-    SQLResponse(const Selection& selection, String&& message);
     SQLResponse(Selection&& selection, const StringView& message);
     SQLResponse(Selection&& selection, String&& message);
+    // take ownership of @cursor
+    SQLResponse(Cursor* cursor, const StringView& message);
+    SQLResponse(Cursor* cursor, String&& message);
+
+    SQLResponse(const SQLResponse& other) = delete;
+    SQLResponse(SQLResponse&& other) noexcept;
+    ~SQLResponse() noexcept;
+    SQLResponse& operator = (const SQLResponse& other) = delete;
+    SQLResponse& operator = (SQLResponse&& other) noexcept;
 
     const String& message() const;
-    const Selection& selection() const;
+    // the selected rows, which may still be read from the tables as they are fetched
+    Cursor& cursor();
+    bool has_selection() const;
+    bool is_error() const;
 };
 
 class SQLProxy
@@ -25,13 +41,33 @@ class SQLProxy
 private:
     static constexpr size_t BUFFER_SIZE = 1024;
     Database& database;
+    // the transaction opened by BEGIN, nullptr while every statement commits on its own
+    Transaction* m_transaction;
+    OutputFormat m_output_format;
+    // for the vectors that don't outlive the statement being executed
+    Arena m_statement_arena;
 public:
     SQLProxy(Database& database);
 
+    SQLProxy(const SQLProxy& other) = delete;
+    ~SQLProxy() noexcept;
+    SQLProxy& operator = (const SQLProxy& other) = delete;
+
+    // @statement without its terminating ';'
+    SQLResponse execute(const StringView& statement);
+    OutputFormat output_format() const;
+
     void run_console_interface();
 private:
     SQLResponse parse_and_execute_cmd(const Vector<String>& tokens);
 
+    // they wait for the writer, which inside a transaction is the transaction itself
+    static bool is_disallowed_in_transaction(const StringView& command);
+    SQLResponse parse_and_execute_begin_cmd(const Vector<String>& tokens);
+    SQLResponse parse_and_execute_commit_cmd(const Vector<String>& tokens);
+    SQLResponse parse_and_execute_rollback_cmd(const Vector<String>& tokens);
+    SQLResponse parse_and_execute_set_cmd(const Vector<String>& tokens);
+
     SQLResponse parse_and_execute_list_tables_cmd(const Vector<String>& tokens);
     SQLResponse parse_and_execute_save_table_cmd(const Vector<String>& tokens);
 
@@ -43,13 +79,28 @@ private:
     SQLResponse parse_and_execute_drop_column_cmd(const Vector<String>& tokens);
     SQLResponse parse_and_execute_rename_column_cmd(const Vector<String>& tokens);
 
+    SQLResponse parse_and_execute_create_index_cmd(const Vector<String>& tokens);
+    SQLResponse parse_and_execute_drop_index_cmd(const Vector<String>& tokens);
+
     Vector<Cell*> eval_partial_row(Vector<Cell*>& partial_row, size_t table_pos, const Vector<String>& column_names);
     SQLResponse parse_and_execute_insert_cmd(const Vector<String>& tokens);
     SQLResponse parse_and_execute_update_cmd(const Vector<String>& tokens);
     SQLResponse parse_and_execute_delete_from_cmd(const Vector<String>& tokens);
     SQLResponse parse_and_execute_truncate_table_cmd(const Vector<String>& tokens);
 
-    AnonymousTable* eval_join_clause(Table* primary_table, const Vector<String>& tokens);
-    Function<bool, Vector<Cell*>> eval_where_clause(const AbstractTable* table, const Vector<String>& tokens);
+    SQLResponse parse_and_execute_vacuum_cmd(const Vector<String>& tokens);
+    SQLResponse parse_and_execute_analyze_cmd(const Vector<String>& tokens);
+    SQLResponse parse_and_execute_show_statistics_cmd(const Vector<String>& tokens);
+
+    // puts the most selective conjuncts first, so that 'and' rejects most rows after evaluating the first one
+    void order_conjuncts_by_selectivity(const Table& table, Vector<VectorView<String>>& conjuncts) const;
+    // narrows the rows of @table that can satisfy @conjuncts using its indexes; returns false if no index applies
+    bool find_index_candidates(const Table& table, const Vector<VectorView<String>>& conjuncts, const Snapshot& snapshot, Vector<size_t>& row_positions) const;
+
+    JoinSource scan_table(size_t table_pos, const Vector<size_t>& joined_table_positions, Vector<VectorView<String>>& where_conjuncts, const Snapshot& snapshot);
+    // the primary table first, then the joined ones as written; looked up under the catalog latch, before the statement latches them
+    Vector<size_t> resolve_joined_tables(size_t primary_table_pos, const VectorView<String>& tokens) const;
+    AnonymousTable* eval_join_clause(const Vector<size_t>& joined_table_positions, const VectorView<String>& tokens, Vector<VectorView<String>>& where_conjuncts, const Vector<String>& referenced_column_names, const Snapshot& snapshot);
+    Function<bool, Vector<Cell*>> eval_where_clause(const AbstractTable* table, const VectorView<String>& tokens);
     SQLResponse parse_and_execute_select_cmd(const Vector<String>& tokens);
 };
\ No newline at end of file
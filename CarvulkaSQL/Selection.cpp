@@ -2,34 +2,130 @@
 
 using namespace std;
 
+void Selection::free()
+{
+    for (size_t i = 0; i < m_rows.size(); i += 1)
+    {
+        Table::free_row(m_rows[i]);
+    }
+}
+
 Selection::Selection() : m_columns(), m_rows() {}
+Selection::Selection(const Vector<Column>& columns) : m_columns(columns), m_rows() {}
 
-Selection::Selection(const AbstractTable& table, const Vector<String>& column_names, const Function<bool, Vector<Cell*>>& condition) : m_columns(), m_rows()
+Vector<size_t> Selection::select_columns_from(const AbstractTable& table, const Vector<String>& column_names)
 {
     Vector<size_t> column_indices = move(table.map_column_names_to_indices(column_names));
-    if (column_indices.is_empty()) return;
-
     m_columns.resize_capacity_to(column_indices.size());
     for (size_t i = 0; i < column_indices.size(); i += 1)
     {
         m_columns.append(table.columns()[column_indices[i]]);
     }
+    return column_indices;
+}
+Selection::Selection(const AbstractTable& table, const Vector<String>& column_names, const Function<bool, Vector<Cell*>>& condition) : m_columns(), m_rows()
+{
+    Vector<size_t> column_indices = move(select_columns_from(table, column_names));
+    if (column_indices.is_empty()) return;
 
-    m_rows.resize_capacity_to(table.rows().size());
-    for (size_t i = 0; i < table.rows().size(); i += 1)
+    m_rows.resize_capacity_to(table.row_count());
+    for (size_t i = 0; i < table.row_count(); i += 1)
     {
-        if (condition(table.rows()[i]))
+        if (condition(table.row(i)))
         {
-            Vector<Cell*> row(column_indices.size());
-            for (size_t j = 0; j < column_indices.size(); j += 1)
-            {
-                row[j] = table.rows()[i][column_indices[j]];
-            }
-            m_rows.append(move(row));
+            append_row_from(table.row(i), column_indices);
+        }
+    }
+}
+Selection::Selection(const AbstractTable& table, const Vector<String>& column_names, const Vector<size_t>& row_positions, const Function<bool, Vector<Cell*>>& condition) : m_columns(), m_rows()
+{
+    Vector<size_t> column_indices = move(select_columns_from(table, column_names));
+    if (column_indices.is_empty()) return;
+
+    m_rows.resize_capacity_to(row_positions.size());
+    for (size_t i = 0; i < row_positions.size(); i += 1)
+    {
+        if (condition(table.row(row_positions[i])))
+        {
+            append_row_from(table.row(row_positions[i]), column_indices);
         }
     }
 }
 
+Selection::Selection(const Selection& other) : m_columns(other.m_columns), m_rows()
+{
+    m_rows.resize_capacity_to(other.m_rows.size());
+    for (size_t i = 0; i < other.m_rows.size(); i += 1)
+    {
+        m_rows.append(move(Table::copy_row_from(other.m_rows[i])));
+    }
+}
+Selection::Selection(Selection&& other) noexcept : m_columns(move(other.m_columns)), m_rows(move(other.m_rows)) {}
+Selection::~Selection() noexcept
+{
+    free();
+}
+Selection& Selection::operator = (const Selection& other)
+{
+    if (this != &other)
+    {
+        free();
+        m_columns = other.m_columns;
+        m_rows = Vector<Vector<Cell*>>();
+        m_rows.resize_capacity_to(other.m_rows.size());
+        for (size_t i = 0; i < other.m_rows.size(); i += 1)
+        {
+            m_rows.append(move(Table::copy_row_from(other.m_rows[i])));
+        }
+    }
+    return *this;
+}
+Selection& Selection::operator = (Selection&& other) noexcept
+{
+    if (this != &other)
+    {
+        free();
+        m_columns = move(other.m_columns);
+        m_rows = move(other.m_rows);
+    }
+    return *this;
+}
+
+const Vector<Column>& Selection::columns() const
+{
+    return m_columns;
+}
+const Vector<Vector<Cell*>>& Selection::rows() const
+{
+    return m_rows;
+}
+
+void Selection::append_row_from(const Vector<Cell*>& src, const Vector<size_t>& column_indices)
+{
+    Vector<Cell*> row(column_indices.size(), nullptr);
+    for (size_t j = 0; j < column_indices.size(); j += 1)
+    {
+        if (src[column_indices[j]] != nullptr)
+        {
+            row[j] = src[column_indices[j]]->clone();
+        }
+    }
+    m_rows.append(move(row));
+}
+void Selection::append_row(Vector<Cell*>&& row)
+{
+    m_rows.append(move(row));
+}
+Vector<Cell*> Selection::release_row(size_t row_pos)
+{
+    return move(m_rows[row_pos]);
+}
+void Selection::clear_rows()
+{
+    free();
+    m_rows.clear();
+}
+
 void Selection::order_asc_by(const StringView& column_name)
 {
     size_t column_pos = -1;
@@ -80,109 +176,4 @@ void Selection::order_desc_by(const StringView& column_name)
         }
         m_rows[j + 1] = move(key);
     }
-}
-
-void Selection::print() const
-{
-    if (m_columns.is_empty())
-    {
-        cout << "Empty set\n";
-        return;
-    }
-
-    Vector<size_t> cell_widths;
-    cell_widths.resize_capacity_to(m_columns.size());
-    for (size_t i = 0; i < m_columns.size(); i += 1)
-    {
-        size_t column_width = m_columns[i].name().size(); // at minimum the length of the name of the column
-        for (size_t j = 0; j < m_rows.size(); j += 1)
-        {
-            if (m_rows[j][i] == nullptr)
-            {
-                column_width = max(column_width, size_t(4));
-            }
-            else
-            {
-                column_width = max(column_width, m_rows[j][i]->width());
-            }
-        }
-        cell_widths.append(column_width);
-    }
-
-    // +-...-+
-    for (size_t i = 0; i < m_columns.size(); i += 1)
-    {
-        std::cout << "+-";
-        for (size_t j = 0; j < cell_widths[i]; j += 1)
-        {
-            std::cout << "-";
-        }
-        std::cout << "-";
-    }
-    std::cout << "+\n";
-
-    // | ... |
-    for (size_t i = 0; i < m_columns.size(); i += 1)
-    {
-        std::cout << "| ";
-        std::cout << m_columns[i].name();
-        for (size_t j = 0; j < cell_widths[i] - m_columns[i].name().size(); j += 1)
-        {
-            std::cout << " ";
-        }
-        std::cout << " ";
-    }
-    std::cout << "|\n";
-
-    // +-...-+
-    for (size_t i = 0; i < m_columns.size(); i += 1)
-    {
-        std::cout << "+-";
-        for (size_t j = 0; j < cell_widths[i]; j += 1)
-        {
-            std::cout << "-";
-        }
-        std::cout << "-";
-    }
-    std::cout << "+\n";
-
-    if (m_rows.is_empty()) return;
-    // | ... |
-    for (size_t i = 0; i < m_rows.size(); i += 1)
-    {
-        for (size_t j = 0; j < m_columns.size(); j += 1)
-        {
-            std::cout << "| ";
-            if (m_rows[i][j] == nullptr)
-            {
-                std::cout << "NULL";
-                for (size_t k = 0; k < cell_widths[j] - size_t(4); k += 1)
-                {
-                    std::cout << " ";
-                }
-            }
-            else
-            {
-                std::cout << m_rows[i][j]->convert_to_string();
-                for (size_t k = 0; k < cell_widths[j] - m_rows[i][j]->width(); k += 1)
-                {
-                    std::cout << " ";
-                }
-            }
-            std::cout << " ";
-        }
-        std::cout << "|\n";
-    }
-
-    // +-...-+
-    for (size_t i = 0; i < m_columns.size(); i += 1)
-    {
-        std::cout << "+-";
-        for (size_t j = 0; j < cell_widths[i]; j += 1)
-        {
-            std::cout << "-";
-        }
-        std::cout << "-";
-    }
-    std::cout << "+\n";
 }
\ No newline at end of file
@@ -2,17 +2,41 @@
 
 #include "Table.hpp"
 
+// owns copies of the selected cells, so it stays valid after the table it was selected from changes
 class Selection
 {
 private:
     Vector<Column> m_columns;
     Vector<Vector<Cell*>> m_rows;
+private:
+    void free();
+    // returns the positions of the selected columns in @table
+    Vector<size_t> select_columns_from(const AbstractTable& table, const Vector<String>& column_names);
 public:
     Selection();
+    // no rows yet, they are appended
+    Selection(const Vector<Column>& columns);
     Selection(const AbstractTable& table, const Vector<String>& column_names, const Function<bool, Vector<Cell*>>& condition);
+    // only considers the rows of @row_positions, in that order
+    Selection(const AbstractTable& table, const Vector<String>& column_names, const Vector<size_t>& row_positions, const Function<bool, Vector<Cell*>>& condition);
+
+    Selection(const Selection& other);
+    Selection(Selection&& other) noexcept;
+    ~Selection() noexcept;
+    Selection& operator = (const Selection& other);
+    Selection& operator = (Selection&& other) noexcept;
+
+    const Vector<Column>& columns() const;
+    const Vector<Vector<Cell*>>& rows() const;
+
+    // appends copies of the cells of @row at @column_indices
+    void append_row_from(const Vector<Cell*>& row, const Vector<size_t>& column_indices);
+    void append_row(Vector<Cell*>&& row);
+    // leaves an empty row behind
+    Vector<Cell*> release_row(size_t row_pos);
+    // keeps the columns
+    void clear_rows();
 
     void order_asc_by(const StringView& column_name);
     void order_desc_by(const StringView& column_name);
-
-    void print() const;
 };
\ No newline at end of file
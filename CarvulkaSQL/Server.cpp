@@ -0,0 +1,427 @@
+#include "Server.hpp"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <cerrno>
+#endif
+
+using namespace std;
+
+#ifdef __linux__
+
+static void set_non_blocking(int socket)
+{
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+}
+
+// the socket is non-blocking, so a client that reads slowly makes the executor wait here instead of the event loop, for up to Server::SEND_TIMEOUT
+// returns false if the bytes couldn't all be sent by then
+static bool send_all(int socket, const Vector<uint8_t>& bytes)
+{
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + Server::SEND_TIMEOUT;
+    size_t sent_size = 0;
+    while (sent_size < bytes.size())
+    {
+        ssize_t result = send(socket, bytes.data() + sent_size, bytes.size() - sent_size, MSG_NOSIGNAL);
+        if (result > 0)
+        {
+            sent_size += result;
+        }
+        else if (result == -1 and (errno == EAGAIN or errno == EWOULDBLOCK))
+        {
+            chrono::milliseconds time_left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+            if (time_left.count() <= 0) return false;
+            pollfd descriptor = { socket, POLLOUT, 0 };
+            poll(&descriptor, 1, static_cast<int>(time_left.count()));
+        }
+        else if (result == -1 and errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static sockaddr_un make_unix_address(const StringView& path)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) throw exception("socket path too long");
+    for (size_t i = 0; i < path.size(); i += 1)
+    {
+        address.sun_path[i] = path[i];
+    }
+    return address;
+}
+
+/* Connection */
+
+Server::Connection::Connection(int socket, Database& database) : socket(socket), input(), unchecked_input_pos(0), session(database), is_closed_by_peer(false),
+    is_served(false) {}
+
+/* Server */
+
+Server::Server(Database& database, const char* socket_path, uint16_t port, size_t executor_count) : m_database(database), m_socket_path(), m_epoll(-1), m_unix_listener(-1),
+    m_tcp_listener(-1), m_stop_event(-1), m_executor_count(max(executor_count, size_t(1))), m_mutex(), m_has_ready_connections(), m_ready_connections(), m_connections(), m_is_stopping(false)
+{
+    m_epoll = epoll_create1(0);
+    m_stop_event = eventfd(0, EFD_NONBLOCK);
+    if (m_epoll == -1 or m_stop_event == -1)
+    {
+        free();
+        throw exception("could not create the event loop");
+    }
+    // listeners and the stop event are told apart from connections by their pointers
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = &m_stop_event;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_stop_event, &event);
+
+    if (socket_path != nullptr)
+    {
+        m_socket_path = socket_path;
+        m_unix_listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address;
+        try { address = make_unix_address(m_socket_path); }
+        catch (const exception&)
+        {
+            m_socket_path = String();
+            free();
+            throw;
+        }
+        // a socket file left behind by a server that didn't shut down cleanly
+        unlink(address.sun_path);
+        if (m_unix_listener == -1 or bind(m_unix_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 or listen(m_unix_listener, SOMAXCONN) == -1)
+        {
+            m_socket_path = String();
+            free();
+            throw exception("could not listen on the Unix domain socket");
+        }
+        set_non_blocking(m_unix_listener);
+        event.data.ptr = &m_unix_listener;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_unix_listener, &event);
+    }
+
+    if (port != 0)
+    {
+        m_tcp_listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        int is_reusable = 1;
+        setsockopt(m_tcp_listener, SOL_SOCKET, SO_REUSEADDR, &is_reusable, sizeof(is_reusable));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (m_tcp_listener == -1 or bind(m_tcp_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 or listen(m_tcp_listener, SOMAXCONN) == -1)
+        {
+            free();
+            throw exception("could not listen on the TCP port");
+        }
+        set_non_blocking(m_tcp_listener);
+        event.data.ptr = &m_tcp_listener;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_tcp_listener, &event);
+    }
+}
+Server::~Server() noexcept
+{
+    free();
+}
+
+void Server::free()
+{
+    for (size_t i = 0; i < m_connections.size(); i += 1)
+    {
+        ::close(m_connections[i]->socket);
+        delete m_connections[i];
+    }
+    m_connections.clear();
+    if (m_unix_listener != -1)
+    {
+        ::close(m_unix_listener);
+        m_unix_listener = -1;
+        if (not m_socket_path.is_empty())
+        {
+            unlink(make_unix_address(m_socket_path).sun_path);
+        }
+    }
+    if (m_tcp_listener != -1)
+    {
+        ::close(m_tcp_listener);
+        m_tcp_listener = -1;
+    }
+    if (m_stop_event != -1)
+    {
+        ::close(m_stop_event);
+        m_stop_event = -1;
+    }
+    if (m_epoll != -1)
+    {
+        ::close(m_epoll);
+        m_epoll = -1;
+    }
+}
+
+void Server::run()
+{
+    Vector<thread> executors;
+    for (size_t i = 0; i < m_executor_count; i += 1)
+    {
+        executors.append(thread(&Server::run_executor, this));
+    }
+
+    epoll_event events[MAX_EVENT_COUNT];
+    bool is_stopping = false;
+    while (not is_stopping)
+    {
+        int event_count = epoll_wait(m_epoll, events, MAX_EVENT_COUNT, -1);
+        for (int i = 0; i < event_count; i += 1)
+        {
+            void* source = events[i].data.ptr;
+            if (source == &m_stop_event)
+            {
+                is_stopping = true;
+            }
+            else if (source == &m_unix_listener or source == &m_tcp_listener)
+            {
+                accept_connections(*static_cast<int*>(source));
+            }
+            else
+            {
+                read_requests(static_cast<Connection*>(source));
+            }
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_is_stopping = true;
+    }
+    m_has_ready_connections.notify_all();
+    for (size_t i = 0; i < executors.size(); i += 1)
+    {
+        executors[i].join();
+    }
+}
+
+void Server::stop()
+{
+    uint64_t increment = 1;
+    // nothing to do if it fails: the counter is then already nonzero
+    ssize_t result = write(m_stop_event, &increment, sizeof(increment));
+    (void)result;
+}
+
+void Server::accept_connections(int listener)
+{
+    while (true)
+    {
+        int socket = accept(listener, nullptr, nullptr);
+        if (socket == -1) return;
+
+        set_non_blocking(socket);
+        if (listener == m_tcp_listener)
+        {
+            // responses are written whole, so there is nothing to gain from delaying small ones
+            int is_no_delay = 1;
+            setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &is_no_delay, sizeof(is_no_delay));
+        }
+
+        Connection* connection = new Connection(socket, m_database);
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_connections.append(connection);
+        }
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        event.data.ptr = connection;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &event);
+    }
+}
+
+void Server::read_requests(Connection* connection)
+{
+    // pairs with the release in watch(), after which the executor doesn't touch the connection any more
+    connection->is_served.load(memory_order_acquire);
+    while (connection->input.size() < MAX_INPUT_SIZE)
+    {
+        // received straight into the end of the buffer, which grows geometrically rather than by a chunk per read
+        size_t input_size = connection->input.size();
+        size_t read_size = min(READ_CHUNK_SIZE, MAX_INPUT_SIZE - input_size);
+        if (input_size + read_size > connection->input.capacity())
+        {
+            connection->input.reserve(min(max(input_size + read_size, 2 * connection->input.capacity()), MAX_INPUT_SIZE));
+        }
+        connection->input.resize_to(input_size + read_size);
+        ssize_t result = recv(connection->socket, connection->input.data() + input_size, read_size, 0);
+        connection->input.resize_to(input_size + max(result, ssize_t(0)));
+        if (result > 0)
+        {
+            continue;
+        }
+        else if (result == -1 and errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            // 0 once the peer shut its side down; EAGAIN once everything sent so far was read
+            connection->is_closed_by_peer = result == 0 or (errno != EAGAIN and errno != EWOULDBLOCK);
+            break;
+        }
+    }
+
+    // pipelined requests are checked too, not only the one at the front
+    while (connection->unchecked_input_pos + FRAME_HEADER_SIZE <= connection->input.size())
+    {
+        size_t frame_size = read_uint32_from(connection->input.data() + connection->unchecked_input_pos);
+        if (frame_size > MAX_REQUEST_SIZE)
+        {
+            Vector<uint8_t> output;
+            append_status_frame_to(output, true, "runtime error: request too large");
+            send_all(connection->socket, output);
+            close(connection);
+            return;
+        }
+        connection->unchecked_input_pos += FRAME_HEADER_SIZE + frame_size;
+    }
+
+    if (has_complete_frame(connection->input))
+    {
+        connection->is_served.store(true, memory_order_relaxed);
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_ready_connections.append(connection);
+        }
+        m_has_ready_connections.notify_one();
+    }
+    else if (connection->is_closed_by_peer)
+    {
+        close(connection);
+    }
+    else
+    {
+        watch(connection);
+    }
+}
+
+void Server::run_executor()
+{
+    while (true)
+    {
+        Connection* connection = nullptr;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_has_ready_connections.wait(lock, [this]() -> bool { return m_is_stopping or not m_ready_connections.is_empty(); });
+            if (m_is_stopping) return;
+            connection = m_ready_connections.front();
+            m_ready_connections.erase(0);
+        }
+        serve(connection);
+    }
+}
+
+void Server::serve(Connection* connection)
+{
+    // the requests that arrived together are answered together, unless their responses grow large
+    Vector<uint8_t> output;
+    while (has_complete_frame(connection->input))
+    {
+        size_t frame_size = read_frame_size(connection->input);
+        StringView statement(reinterpret_cast<const char*>(connection->input.data() + FRAME_HEADER_SIZE), frame_size);
+
+        SQLResponse response = connection->session.execute(statement);
+        connection->input.erase(0, FRAME_HEADER_SIZE + frame_size);
+        connection->unchecked_input_pos -= FRAME_HEADER_SIZE + frame_size;
+        if (response.has_selection())
+        {
+            append_columns_frame_to(output, response.cursor().columns());
+            Selection batch(response.cursor().columns());
+            while (response.cursor().fetch_into(batch))
+            {
+                if (connection->session.output_format() == OutputFormat::BINARY)
+                {
+                    append_columnar_frame_to(output, batch);
+                }
+                else
+                {
+                    append_rows_frames_to(output, batch);
+                }
+                if (output.size() < SEND_THRESHOLD) continue;
+                if (not send_all(connection->socket, output))
+                {
+                    close(connection);
+                    return;
+                }
+                output.clear();
+            }
+        }
+        append_status_frame_to(output, response.is_error(), response.message());
+    }
+
+    if (not send_all(connection->socket, output) or connection->is_closed_by_peer)
+    {
+        close(connection);
+        return;
+    }
+    watch(connection);
+}
+
+void Server::watch(Connection* connection)
+{
+    int socket = connection->socket;
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.ptr = connection;
+    // the connection isn't touched past this point, another thread may own it as soon as it is rearmed
+    connection->is_served.store(false, memory_order_release);
+    epoll_ctl(m_epoll, EPOLL_CTL_MOD, socket, &event);
+}
+
+void Server::close(Connection* connection)
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_connections.erase(m_connections.find(connection));
+    }
+    // closing the socket also removes it from epoll
+    ::close(connection->socket);
+    delete connection;
+}
+
+#else
+
+Server::Connection::Connection(int socket, Database& database) : socket(socket), input(), unchecked_input_pos(0), session(database), is_closed_by_peer(false),
+    is_served(false) {}
+
+Server::Server(Database& database, const char* socket_path, uint16_t port, size_t executor_count) : m_database(database), m_socket_path(), m_epoll(-1), m_unix_listener(-1),
+    m_tcp_listener(-1), m_stop_event(-1), m_executor_count(executor_count), m_mutex(), m_has_ready_connections(), m_ready_connections(), m_connections(), m_is_stopping(false)
+{
+    throw exception("server mode is only available on Linux");
+}
+Server::~Server() noexcept {}
+
+void Server::free() {}
+
+void Server::run() {}
+void Server::stop() {}
+
+void Server::run_executor() {}
+void Server::accept_connections(int listener) {}
+void Server::read_requests(Connection* connection) {}
+void Server::serve(Connection* connection) {}
+void Server::watch(Connection* connection) {}
+void Server::close(Connection* connection) {}
+
+#endif
\ No newline at end of file
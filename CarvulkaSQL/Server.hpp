@@ -0,0 +1,81 @@
+#pragma once
+
+#include "SQLProxy.hpp"
+#include "WireProtocol.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+// serves the database to local clients over a Unix domain socket and a TCP port bound to localhost, speaking the protocol of WireProtocol.hpp
+// one thread waits on the sockets with epoll and reads the requests, a fixed pool of executors runs them; every connection is a session
+// of its own, whose requests run one at a time and in order
+// Linux only: elsewhere constructing a server throws
+class Server
+{
+public:
+    static constexpr const char* DEFAULT_SOCKET_PATH = "csql.sock";
+    static constexpr uint16_t DEFAULT_PORT = 6250;
+    static constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+    // the most bytes of requests buffered for a connection; past it the server stops reading from it until they ran, and the client
+    // waits in send; it holds a request of the largest size allowed, so a full buffer always starts with a complete one
+    static constexpr size_t MAX_INPUT_SIZE = 2 * (FRAME_HEADER_SIZE + MAX_REQUEST_SIZE);
+    // the output buffered for a connection is sent once it grows past this, so that a large selection is streamed
+    static constexpr size_t SEND_THRESHOLD = 64 * 1024;
+    // a client that takes longer than this to make room for a response is disconnected: while a selection is streamed, its cursor holds
+    // the latches of the tables read, and a schema change waiting for them would in turn hold up every other statement
+    static constexpr std::chrono::milliseconds SEND_TIMEOUT = std::chrono::milliseconds(5000);
+    static constexpr int MAX_EVENT_COUNT = 64;
+private:
+    struct Connection
+    {
+        int socket;
+        Vector<uint8_t> input;
+        // where the first frame in input whose header wasn't checked yet starts; every header is checked as soon as it arrives
+        size_t unchecked_input_pos;
+        SQLProxy session;
+        bool is_closed_by_peer;
+        // set while an executor owns the connection; epoll hands it back in order, but only this flag tells the memory model so
+        std::atomic<bool> is_served;
+
+        Connection(int socket, Database& database);
+    };
+private:
+    Database& m_database;
+    String m_socket_path; // empty if there is no Unix domain socket
+    int m_epoll;
+    int m_unix_listener;
+    int m_tcp_listener;
+    int m_stop_event;
+    size_t m_executor_count;
+    std::mutex m_mutex;
+    std::condition_variable m_has_ready_connections;
+    // a connection is in here while its requests wait for an executor; epoll doesn't report it again until they ran
+    Vector<Connection*> m_ready_connections;
+    Vector<Connection*> m_connections;
+    bool m_is_stopping;
+private:
+    // closes the connections and every descriptor the server opened
+    void free();
+    void run_executor();
+    void accept_connections(int listener);
+    void read_requests(Connection* connection);
+    void serve(Connection* connection);
+    // has epoll report the connection's next requests
+    void watch(Connection* connection);
+    // rolls back the session's open transaction, if it has one
+    void close(Connection* connection);
+public:
+    // no Unix domain socket if @socket_path is nullptr, no TCP port if @port is 0
+    Server(Database& database, const char* socket_path, uint16_t port, size_t executor_count);
+
+    Server(const Server& other) = delete;
+    ~Server() noexcept;
+    Server& operator = (const Server& other) = delete;
+
+    // returns once stop() was called and every executor finished
+    void run();
+    // safe to call from a signal handler
+    void stop();
+};
\ No newline at end of file
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Vector.hpp"
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <new>
+
+// hands out objects of type T from slabs of SLAB_SIZE bytes, which it allocates as needed and keeps until cleared;
+// the slot of a destroyed object goes to the next one created, so that many small objects don't each take a trip through the heap
+// a slab is aligned to its size, so that the slab of an object is found from its address; a bit per slot tells whether it holds one
+// only one thread may create and destroy at a time, the sizes may be read meanwhile
+template<typename T>
+class SlabPool
+{
+public:
+    using type = T;
+    using ptr = type*;
+    using ptr_to_const = const type*;
+    static constexpr size_t SLAB_SIZE = 16384;
+private:
+    union Slot
+    {
+        Slot* next_free;
+        alignas(type) unsigned char bytes[sizeof(type)];
+    };
+    static constexpr size_t BITMAP_WORD_COUNT = (SLAB_SIZE / sizeof(Slot) + 63) / 64;
+    static constexpr size_t SLOTS_PER_SLAB = (SLAB_SIZE - BITMAP_WORD_COUNT * sizeof(uint64_t)) / sizeof(Slot);
+    struct Slab
+    {
+        uint64_t live_bits[BITMAP_WORD_COUNT];
+        Slot slots[SLOTS_PER_SLAB];
+    };
+    static_assert(sizeof(Slab) <= SLAB_SIZE and alignof(Slot) <= alignof(uint64_t));
+
+    Vector<Slab*> m_slabs;
+    Slot* m_free_slot;
+    std::atomic<size_t> m_size;
+    std::atomic<size_t> m_slab_count;
+private:
+    static Slab* find_slab_of(const void* object)
+    {
+        return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(object) & ~static_cast<uintptr_t>(SLAB_SIZE - 1));
+    }
+    void add_slab()
+    {
+        Slab* slab = static_cast<Slab*>(::operator new(SLAB_SIZE, std::align_val_t(SLAB_SIZE)));
+        for (size_t i = 0; i < BITMAP_WORD_COUNT; i += 1)
+        {
+            slab->live_bits[i] = 0;
+        }
+        // the first slot ends up first in the list, so that the slab fills up in address order
+        for (size_t i = SLOTS_PER_SLAB; i > 0; i -= 1)
+        {
+            slab->slots[i - 1].next_free = m_free_slot;
+            m_free_slot = &slab->slots[i - 1];
+        }
+        m_slabs.append(slab);
+        m_slab_count.store(m_slabs.size(), std::memory_order_relaxed);
+    }
+    void free()
+    {
+        for (size_t i = 0; i < m_slabs.size(); i += 1)
+        {
+            Slab* slab = m_slabs[i];
+            for (size_t j = 0; j < BITMAP_WORD_COUNT; j += 1)
+            {
+                for (uint64_t bits = slab->live_bits[j]; bits != 0; bits &= bits - 1)
+                {
+                    size_t slot_pos = 64 * j + std::countr_zero(bits);
+                    reinterpret_cast<ptr>(slab->slots[slot_pos].bytes)->~type();
+                }
+            }
+            ::operator delete(slab, std::align_val_t(SLAB_SIZE));
+        }
+    }
+public:
+    SlabPool() : m_slabs(), m_free_slot(nullptr), m_size(0), m_slab_count(0) {}
+
+    SlabPool(const SlabPool<type>& other) = delete;
+    SlabPool(SlabPool<type>&& other) noexcept : m_slabs(std::move(other.m_slabs)), m_free_slot(other.m_free_slot), m_size(other.m_size.load()), m_slab_count(other.m_slab_count.load())
+    {
+        other.m_free_slot = nullptr;
+        other.m_size.store(0);
+        other.m_slab_count.store(0);
+    }
+    ~SlabPool() noexcept
+    {
+        free();
+    }
+    SlabPool<type>& operator = (const SlabPool<type>& other) = delete;
+    SlabPool<type>& operator = (SlabPool<type>&& other) noexcept
+    {
+        if (this != &other)
+        {
+            free();
+            m_slabs = std::move(other.m_slabs);
+            m_free_slot = other.m_free_slot;
+            m_size.store(other.m_size.load());
+            m_slab_count.store(other.m_slab_count.load());
+            other.m_free_slot = nullptr;
+            other.m_size.store(0);
+            other.m_slab_count.store(0);
+        }
+        return *this;
+    }
+
+    // the objects alive
+    size_t size() const
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+    // the bytes the objects alive take, not counting what they allocate themselves
+    size_t used_bytes() const
+    {
+        return size() * sizeof(type);
+    }
+    // the bytes of the slabs
+    size_t reserved_bytes() const
+    {
+        return m_slab_count.load(std::memory_order_relaxed) * SLAB_SIZE;
+    }
+
+    template<typename... Args>
+    ptr create(Args&&... args)
+    {
+        if (m_free_slot == nullptr)
+        {
+            add_slab();
+        }
+        Slot* slot = m_free_slot;
+        Slot* next_free = slot->next_free;
+        ptr object = new (slot->bytes) type(std::forward<Args>(args)...);
+        m_free_slot = next_free;
+
+        Slab* slab = find_slab_of(slot);
+        size_t slot_pos = slot - slab->slots;
+        slab->live_bits[slot_pos / 64] |= uint64_t(1) << (slot_pos % 64);
+        m_size.store(m_size.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return object;
+    }
+    // @object must have been created by this pool
+    void destroy(ptr_to_const object)
+    {
+        Slot* slot = reinterpret_cast<Slot*>(const_cast<ptr>(object));
+        Slab* slab = find_slab_of(slot);
+        size_t slot_pos = slot - slab->slots;
+        slab->live_bits[slot_pos / 64] &= ~(uint64_t(1) << (slot_pos % 64));
+        object->~type();
+        slot->next_free = m_free_slot;
+        m_free_slot = slot;
+        m_size.store(m_size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    }
+    // destroys every object and releases the slabs all at once
+    void clear()
+    {
+        free();
+        m_slabs.clear();
+        m_free_slot = nullptr;
+        m_size.store(0, std::memory_order_relaxed);
+        m_slab_count.store(0, std::memory_order_relaxed);
+    }
+};
\ No newline at end of file
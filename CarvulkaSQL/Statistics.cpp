@@ -0,0 +1,518 @@
+#include "Statistics.hpp"
+#include <bit>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/* HyperLogLog */
+
+HyperLogLog::HyperLogLog()
+{
+    clear();
+}
+
+void HyperLogLog::add(uint64_t hash)
+{
+    size_t register_pos = hash >> (64 - PRECISION);
+    // position of the first set bit among the remaining 64 - PRECISION bits
+    uint8_t rank = static_cast<uint8_t>(min(countl_zero(hash << PRECISION), 64 - PRECISION) + 1);
+    if (rank > m_registers[register_pos])
+    {
+        m_registers[register_pos] = rank;
+    }
+}
+
+double HyperLogLog::estimate() const
+{
+    double sum = 0.0;
+    size_t zero_register_count = 0;
+    for (size_t i = 0; i < REGISTER_COUNT; i += 1)
+    {
+        sum += ldexp(1.0, -m_registers[i]);
+        if (m_registers[i] == 0)
+        {
+            zero_register_count += 1;
+        }
+    }
+    double m = static_cast<double>(REGISTER_COUNT);
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    // small range correction: linear counting while registers are still empty
+    if (estimate <= 2.5 * m and zero_register_count != 0)
+    {
+        estimate = m * log(m / static_cast<double>(zero_register_count));
+    }
+    return estimate;
+}
+
+void HyperLogLog::clear()
+{
+    for (size_t i = 0; i < REGISTER_COUNT; i += 1)
+    {
+        m_registers[i] = 0;
+    }
+}
+
+/* ColumnStatistics */
+
+void ColumnStatistics::free()
+{
+    delete m_min;
+    delete m_max;
+}
+
+ColumnStatistics::ColumnStatistics() : m_distinct_values(), m_null_count(0), m_min(nullptr), m_max(nullptr) {}
+
+ColumnStatistics::ColumnStatistics(const ColumnStatistics& other) : m_distinct_values(other.m_distinct_values), m_null_count(other.m_null_count),
+    m_min(other.m_min == nullptr ? nullptr : other.m_min->clone()), m_max(other.m_max == nullptr ? nullptr : other.m_max->clone()) {}
+ColumnStatistics::ColumnStatistics(ColumnStatistics&& other) noexcept : m_distinct_values(other.m_distinct_values), m_null_count(other.m_null_count), m_min(other.m_min), m_max(other.m_max)
+{
+    other.m_min = nullptr;
+    other.m_max = nullptr;
+}
+ColumnStatistics::~ColumnStatistics() noexcept
+{
+    free();
+}
+ColumnStatistics& ColumnStatistics::operator = (const ColumnStatistics& other)
+{
+    if (this != &other)
+    {
+        free();
+        m_distinct_values = other.m_distinct_values;
+        m_null_count = other.m_null_count;
+        m_min = other.m_min == nullptr ? nullptr : other.m_min->clone();
+        m_max = other.m_max == nullptr ? nullptr : other.m_max->clone();
+    }
+    return *this;
+}
+ColumnStatistics& ColumnStatistics::operator = (ColumnStatistics&& other) noexcept
+{
+    if (this != &other)
+    {
+        free();
+        m_distinct_values = other.m_distinct_values;
+        m_null_count = other.m_null_count;
+        m_min = other.m_min;
+        m_max = other.m_max;
+        other.m_min = nullptr;
+        other.m_max = nullptr;
+    }
+    return *this;
+}
+
+size_t ColumnStatistics::null_count() const
+{
+    return m_null_count;
+}
+double ColumnStatistics::distinct_count() const
+{
+    return m_distinct_values.estimate();
+}
+const Cell* ColumnStatistics::min() const
+{
+    return m_min;
+}
+const Cell* ColumnStatistics::max() const
+{
+    return m_max;
+}
+
+void ColumnStatistics::add(const Cell* cell)
+{
+    if (cell == nullptr)
+    {
+        m_null_count += 1;
+        return;
+    }
+    m_distinct_values.add(compute_hash_of(cell));
+    if (m_min == nullptr or compare(cell, m_min) == partial_ordering::less)
+    {
+        delete m_min;
+        m_min = cell->clone();
+    }
+    if (m_max == nullptr or compare(cell, m_max) == partial_ordering::greater)
+    {
+        delete m_max;
+        m_max = cell->clone();
+    }
+}
+void ColumnStatistics::add_nulls(size_t count)
+{
+    m_null_count += count;
+}
+void ColumnStatistics::clear()
+{
+    free();
+    m_distinct_values.clear();
+    m_null_count = 0;
+    m_min = nullptr;
+    m_max = nullptr;
+}
+
+/* TableStatistics */
+
+TableStatistics::TableStatistics(size_t column_count) : m_row_count(0), m_columns(column_count) {}
+
+size_t TableStatistics::row_count() const
+{
+    return m_row_count;
+}
+const Vector<ColumnStatistics>& TableStatistics::columns() const
+{
+    return m_columns;
+}
+
+double TableStatistics::null_fraction(size_t column_pos) const
+{
+    if (m_row_count == 0) return 0.0;
+    return static_cast<double>(m_columns[column_pos].null_count()) / static_cast<double>(m_row_count);
+}
+double TableStatistics::distinct_count(size_t column_pos) const
+{
+    double non_null_count = static_cast<double>(m_row_count - m_columns[column_pos].null_count());
+    if (non_null_count == 0.0) return m_row_count == 0 ? 0.0 : 1.0;
+    return std::max(1.0, std::min(m_columns[column_pos].distinct_count(), non_null_count));
+}
+
+void TableStatistics::add_row(const Vector<Cell*>& row)
+{
+    for (size_t i = 0; i < m_columns.size(); i += 1)
+    {
+        m_columns[i].add(row[i]);
+    }
+    m_row_count += 1;
+}
+void TableStatistics::add_column()
+{
+    m_columns.append(ColumnStatistics());
+    m_columns.back().add_nulls(m_row_count);
+}
+void TableStatistics::drop_column(size_t column_pos)
+{
+    m_columns.erase(column_pos);
+}
+void TableStatistics::clear()
+{
+    for (size_t i = 0; i < m_columns.size(); i += 1)
+    {
+        m_columns[i].clear();
+    }
+    m_row_count = 0;
+}
+
+/* ColumnDistribution */
+
+void ColumnDistribution::free()
+{
+    for (size_t i = 0; i < m_most_common_values.size(); i += 1)
+    {
+        delete m_most_common_values[i];
+    }
+    for (size_t i = 0; i < m_histogram_bounds.size(); i += 1)
+    {
+        delete m_histogram_bounds[i];
+    }
+}
+
+ColumnDistribution::ColumnDistribution() : m_null_fraction(0.0), m_most_common_values(), m_most_common_frequencies(), m_histogram_bounds(), m_histogram_fraction(0.0) {}
+
+ColumnDistribution::ColumnDistribution(const ColumnDistribution& other) : m_null_fraction(other.m_null_fraction), m_most_common_values(),
+    m_most_common_frequencies(other.m_most_common_frequencies), m_histogram_bounds(), m_histogram_fraction(other.m_histogram_fraction)
+{
+    for (size_t i = 0; i < other.m_most_common_values.size(); i += 1)
+    {
+        m_most_common_values.append(other.m_most_common_values[i]->clone());
+    }
+    for (size_t i = 0; i < other.m_histogram_bounds.size(); i += 1)
+    {
+        m_histogram_bounds.append(other.m_histogram_bounds[i]->clone());
+    }
+}
+ColumnDistribution::ColumnDistribution(ColumnDistribution&& other) noexcept : m_null_fraction(other.m_null_fraction), m_most_common_values(move(other.m_most_common_values)),
+    m_most_common_frequencies(move(other.m_most_common_frequencies)), m_histogram_bounds(move(other.m_histogram_bounds)), m_histogram_fraction(other.m_histogram_fraction) {}
+ColumnDistribution::~ColumnDistribution() noexcept
+{
+    free();
+}
+ColumnDistribution& ColumnDistribution::operator = (const ColumnDistribution& other)
+{
+    if (this != &other)
+    {
+        *this = ColumnDistribution(other);
+    }
+    return *this;
+}
+ColumnDistribution& ColumnDistribution::operator = (ColumnDistribution&& other) noexcept
+{
+    if (this != &other)
+    {
+        free();
+        m_null_fraction = other.m_null_fraction;
+        m_most_common_values = move(other.m_most_common_values);
+        m_most_common_frequencies = move(other.m_most_common_frequencies);
+        m_histogram_bounds = move(other.m_histogram_bounds);
+        m_histogram_fraction = other.m_histogram_fraction;
+    }
+    return *this;
+}
+
+double ColumnDistribution::null_fraction() const
+{
+    return m_null_fraction;
+}
+const Vector<Cell*>& ColumnDistribution::most_common_values() const
+{
+    return m_most_common_values;
+}
+const Vector<double>& ColumnDistribution::most_common_frequencies() const
+{
+    return m_most_common_frequencies;
+}
+const Vector<Cell*>& ColumnDistribution::histogram_bounds() const
+{
+    return m_histogram_bounds;
+}
+double ColumnDistribution::histogram_fraction() const
+{
+    return m_histogram_fraction;
+}
+
+void ColumnDistribution::set_null_fraction(double null_fraction)
+{
+    m_null_fraction = null_fraction;
+}
+void ColumnDistribution::set_histogram_fraction(double histogram_fraction)
+{
+    m_histogram_fraction = histogram_fraction;
+}
+void ColumnDistribution::add_most_common_value(Cell* value, double frequency)
+{
+    m_most_common_values.append(value);
+    m_most_common_frequencies.append(frequency);
+}
+void ColumnDistribution::add_histogram_bound(Cell* bound)
+{
+    m_histogram_bounds.append(bound);
+}
+
+double ColumnDistribution::estimate_equal_fraction(const Cell* value, double distinct_count) const
+{
+    if (m_most_common_values.is_empty() and m_histogram_bounds.is_empty()) return -1.0;
+
+    for (size_t i = 0; i < m_most_common_values.size(); i += 1)
+    {
+        if (compare(value, m_most_common_values[i]) == partial_ordering::equivalent)
+        {
+            return m_most_common_frequencies[i];
+        }
+    }
+    // a value that isn't among the most common ones gets an even share of the remaining rows
+    double remaining_distinct_count = max(1.0, distinct_count - static_cast<double>(m_most_common_values.size()));
+    return m_histogram_fraction / remaining_distinct_count;
+}
+
+double ColumnDistribution::estimate_less_fraction(const Cell* value) const
+{
+    double fraction = 0.0;
+    for (size_t i = 0; i < m_most_common_values.size(); i += 1)
+    {
+        if (compare(m_most_common_values[i], value) == partial_ordering::less)
+        {
+            fraction += m_most_common_frequencies[i];
+        }
+    }
+    if (m_histogram_bounds.size() < 2) return fraction;
+
+    if (compare(value, m_histogram_bounds.front()) != partial_ordering::greater) return fraction;
+    if (compare(value, m_histogram_bounds.back()) == partial_ordering::greater) return fraction + m_histogram_fraction;
+
+    size_t bucket_count = m_histogram_bounds.size() - 1;
+    for (size_t i = 0; i < bucket_count; i += 1)
+    {
+        if (compare(value, m_histogram_bounds[i + 1]) != partial_ordering::greater)
+        {
+            double position = (static_cast<double>(i) + interpolate_between(value, m_histogram_bounds[i], m_histogram_bounds[i + 1])) / static_cast<double>(bucket_count);
+            return fraction + m_histogram_fraction * position;
+        }
+    }
+    return fraction + m_histogram_fraction;
+}
+
+/* TableAnalysis */
+
+TableAnalysis::TableAnalysis() : m_row_count(0), m_sample_size(0), m_columns() {}
+TableAnalysis::TableAnalysis(size_t row_count, size_t sample_size, size_t column_count) : m_row_count(row_count), m_sample_size(sample_size), m_columns(column_count) {}
+
+TableAnalysis TableAnalysis::analyze(const Vector<const Vector<Cell*>*>& rows, size_t column_count)
+{
+    // reservoir sampling with a fixed seed, so that analyzing the same data twice gives the same result
+    Vector<size_t> sample_row_ids;
+    sample_row_ids.resize_capacity_to(min(rows.size(), SAMPLE_SIZE));
+    uint64_t random_state = 0x9e3779b97f4a7c15ull;
+    for (size_t i = 0; i < rows.size(); i += 1)
+    {
+        if (i < SAMPLE_SIZE)
+        {
+            sample_row_ids.append(i);
+            continue;
+        }
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 7;
+        random_state ^= random_state << 17;
+        size_t replaced_pos = random_state % (i + 1);
+        if (replaced_pos < SAMPLE_SIZE)
+        {
+            sample_row_ids[replaced_pos] = i;
+        }
+    }
+
+    TableAnalysis analysis(rows.size(), sample_row_ids.size(), column_count);
+    if (sample_row_ids.is_empty()) return analysis;
+
+    double sample_size = static_cast<double>(sample_row_ids.size());
+    for (size_t j = 0; j < column_count; j += 1)
+    {
+        ColumnDistribution& distribution = analysis.m_columns[j];
+
+        Vector<const Cell*> values;
+        values.resize_capacity_to(sample_row_ids.size());
+        for (size_t i = 0; i < sample_row_ids.size(); i += 1)
+        {
+            const Vector<Cell*>& row = *rows[sample_row_ids[i]];
+            if (row[j] != nullptr)
+            {
+                values.append(row[j]);
+            }
+        }
+        distribution.set_null_fraction(1.0 - static_cast<double>(values.size()) / sample_size);
+        if (values.is_empty()) continue;
+
+        sort(values.data(), values.data() + values.size(), [](const Cell* lhs, const Cell* rhs) -> bool { return compare(lhs, rhs) == partial_ordering::less; });
+
+        // runs of equal values, as (first pos, length)
+        Vector<size_t> run_positions;
+        Vector<size_t> run_lengths;
+        for (size_t i = 0; i < values.size(); i += 1)
+        {
+            if (i != 0 and compare(values[i], values[i - 1]) == partial_ordering::equivalent)
+            {
+                run_lengths.back() += 1;
+            }
+            else
+            {
+                run_positions.append(i);
+                run_lengths.append(1);
+            }
+        }
+
+        // a value is common if it occurs more than once and more often than the average value
+        double average_run_length = static_cast<double>(values.size()) / static_cast<double>(run_lengths.size());
+        Vector<bool> is_most_common(run_lengths.size(), false);
+        for (size_t k = 0; k < MOST_COMMON_VALUE_COUNT; k += 1)
+        {
+            size_t longest_run_pos = -1;
+            for (size_t i = 0; i < run_lengths.size(); i += 1)
+            {
+                if (is_most_common[i] or run_lengths[i] < 2 or static_cast<double>(run_lengths[i]) <= average_run_length) continue;
+                if (longest_run_pos == -1 or run_lengths[i] > run_lengths[longest_run_pos])
+                {
+                    longest_run_pos = i;
+                }
+            }
+            if (longest_run_pos == -1) break;
+
+            is_most_common[longest_run_pos] = true;
+            distribution.add_most_common_value(values[run_positions[longest_run_pos]]->clone(), static_cast<double>(run_lengths[longest_run_pos]) / sample_size);
+        }
+
+        Vector<const Cell*> remaining_values;
+        remaining_values.resize_capacity_to(values.size());
+        for (size_t i = 0; i < run_lengths.size(); i += 1)
+        {
+            if (is_most_common[i]) continue;
+
+            for (size_t k = 0; k < run_lengths[i]; k += 1)
+            {
+                remaining_values.append(values[run_positions[i] + k]);
+            }
+        }
+        distribution.set_histogram_fraction(static_cast<double>(remaining_values.size()) / sample_size);
+        if (remaining_values.size() < 2) continue;
+
+        size_t bucket_count = min(HISTOGRAM_BUCKET_COUNT, remaining_values.size() - 1);
+        for (size_t i = 0; i <= bucket_count; i += 1)
+        {
+            distribution.add_histogram_bound(remaining_values[i * (remaining_values.size() - 1) / bucket_count]->clone());
+        }
+    }
+    return analysis;
+}
+
+bool TableAnalysis::is_empty() const
+{
+    return m_columns.is_empty();
+}
+size_t TableAnalysis::row_count() const
+{
+    return m_row_count;
+}
+size_t TableAnalysis::sample_size() const
+{
+    return m_sample_size;
+}
+const Vector<ColumnDistribution>& TableAnalysis::columns() const
+{
+    return m_columns;
+}
+ColumnDistribution& TableAnalysis::column(size_t column_pos)
+{
+    return m_columns[column_pos];
+}
+
+void TableAnalysis::add_column()
+{
+    if (is_empty()) return;
+
+    m_columns.append(ColumnDistribution());
+    m_columns.back().set_null_fraction(1.0);
+}
+void TableAnalysis::drop_column(size_t column_pos)
+{
+    if (is_empty()) return;
+
+    m_columns.erase(column_pos);
+}
+
+double interpolate_between(const Cell* value, const Cell* lower, const Cell* upper)
+{
+    if (value == nullptr or lower == nullptr or upper == nullptr or value->data_type != lower->data_type or value->data_type != upper->data_type) return 0.5;
+
+    double value_number = 0.0;
+    double lower_number = 0.0;
+    double upper_number = 0.0;
+    switch (value->data_type)
+    {
+    case DataType::INTEGER:
+    {
+        value_number = static_cast<double>(static_cast<const IntegerCell*>(value)->value);
+        lower_number = static_cast<double>(static_cast<const IntegerCell*>(lower)->value);
+        upper_number = static_cast<double>(static_cast<const IntegerCell*>(upper)->value);
+        break;
+    }
+    case DataType::REAL:
+    {
+        value_number = static_cast<const RealCell*>(value)->value;
+        lower_number = static_cast<const RealCell*>(lower)->value;
+        upper_number = static_cast<const RealCell*>(upper)->value;
+        break;
+    }
+    default:
+    {
+        return 0.5;
+    }
+    }
+    if (upper_number <= lower_number) return 0.5;
+    return max(0.0, min(1.0, (value_number - lower_number) / (upper_number - lower_number)));
+}
\ No newline at end of file
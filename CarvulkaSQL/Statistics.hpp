@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Vector.hpp"
+#include "Cell.hpp"
+
+// estimates the number of distinct hashes added to it using REGISTER_COUNT bytes, with a standard error of about 1.04 / sqrt(REGISTER_COUNT)
+class HyperLogLog
+{
+public:
+    static constexpr uint8_t PRECISION = 10;
+    static constexpr size_t REGISTER_COUNT = size_t(1) << PRECISION;
+private:
+    uint8_t m_registers[REGISTER_COUNT];
+public:
+    HyperLogLog();
+
+    void add(uint64_t hash);
+    double estimate() const;
+    void clear();
+};
+
+class ColumnStatistics
+{
+private:
+    HyperLogLog m_distinct_values;
+    size_t m_null_count;
+    Cell* m_min;
+    Cell* m_max;
+private:
+    void free();
+public:
+    ColumnStatistics();
+
+    ColumnStatistics(const ColumnStatistics& other);
+    ColumnStatistics(ColumnStatistics&& other) noexcept;
+    ~ColumnStatistics() noexcept;
+    ColumnStatistics& operator = (const ColumnStatistics& other);
+    ColumnStatistics& operator = (ColumnStatistics&& other) noexcept;
+
+    size_t null_count() const;
+    double distinct_count() const;
+    // nullptr until a non-null value has been added
+    const Cell* min() const;
+    const Cell* max() const;
+
+    void add(const Cell* cell);
+    void add_nulls(size_t count);
+    void clear();
+};
+
+class TableStatistics
+{
+private:
+    size_t m_row_count;
+    Vector<ColumnStatistics> m_columns;
+public:
+    TableStatistics(size_t column_count);
+
+    size_t row_count() const;
+    const Vector<ColumnStatistics>& columns() const;
+
+    double null_fraction(size_t column_pos) const;
+    // never more than the number of non-null values, never less than 1 for a non-empty table
+    double distinct_count(size_t column_pos) const;
+
+    void add_row(const Vector<Cell*>& row);
+    // the new column is null in every existing row
+    void add_column();
+    void drop_column(size_t column_pos);
+    void clear();
+};
+
+// the distribution of a column's values in the sample ANALYZE took: its most common values, and an equi-depth histogram over the rest
+class ColumnDistribution
+{
+private:
+    double m_null_fraction;
+    Vector<Cell*> m_most_common_values;
+    Vector<double> m_most_common_frequencies; // fractions of all rows
+    Vector<Cell*> m_histogram_bounds; // ascending; each pair of neighbouring bounds encloses about the same number of rows
+    double m_histogram_fraction; // fraction of all rows the histogram describes
+private:
+    void free();
+public:
+    ColumnDistribution();
+
+    ColumnDistribution(const ColumnDistribution& other);
+    ColumnDistribution(ColumnDistribution&& other) noexcept;
+    ~ColumnDistribution() noexcept;
+    ColumnDistribution& operator = (const ColumnDistribution& other);
+    ColumnDistribution& operator = (ColumnDistribution&& other) noexcept;
+
+    double null_fraction() const;
+    const Vector<Cell*>& most_common_values() const;
+    const Vector<double>& most_common_frequencies() const;
+    const Vector<Cell*>& histogram_bounds() const;
+    double histogram_fraction() const;
+
+    void set_null_fraction(double null_fraction);
+    void set_histogram_fraction(double histogram_fraction);
+    // both take ownership of the value
+    void add_most_common_value(Cell* value, double frequency);
+    void add_histogram_bound(Cell* bound);
+
+    // fraction of all rows equal to @value, or -1 if the distribution can't tell
+    double estimate_equal_fraction(const Cell* value, double distinct_count) const;
+    // fraction of all rows less than @value
+    double estimate_less_fraction(const Cell* value) const;
+};
+
+// the result of ANALYZE; kept until the next ANALYZE rather than updated with the table
+class TableAnalysis
+{
+public:
+    static constexpr size_t SAMPLE_SIZE = 30000;
+    static constexpr size_t MOST_COMMON_VALUE_COUNT = 10;
+    static constexpr size_t HISTOGRAM_BUCKET_COUNT = 20;
+private:
+    size_t m_row_count;
+    size_t m_sample_size;
+    Vector<ColumnDistribution> m_columns;
+public:
+    TableAnalysis();
+    TableAnalysis(size_t row_count, size_t sample_size, size_t column_count);
+
+    // samples at most SAMPLE_SIZE of @rows
+    static TableAnalysis analyze(const Vector<const Vector<Cell*>*>& rows, size_t column_count);
+
+    bool is_empty() const;
+    size_t row_count() const;
+    size_t sample_size() const;
+    const Vector<ColumnDistribution>& columns() const;
+    ColumnDistribution& column(size_t column_pos);
+
+    void add_column();
+    void drop_column(size_t column_pos);
+};
+
+// relative position of @value between @lower and @upper in [0, 1]; 0.5 when it can't be interpolated
+double interpolate_between(const Cell* value, const Cell* lower, const Cell* upper);
\ No newline at end of file
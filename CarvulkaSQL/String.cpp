@@ -14,46 +14,71 @@ void String::free()
     {
         m_data[i].~char_type();
     }
-    ::operator delete(m_data);
+    if (not is_inline())
+    {
+        ::operator delete(m_data);
+    }
+}
+bool String::is_inline() const
+{
+    return m_data == m_inline;
+}
+void String::steal(String& other)
+{
+    m_size = other.m_size;
+    if (other.is_inline())
+    {
+        m_data = m_inline;
+        for (size_t i = 0; i < m_size; i += 1)
+        {
+            new (m_data + i) char_type(other.m_data[i]);
+        }
+    }
+    else
+    {
+        m_data = other.m_data;
+        m_capacity = other.m_capacity;
+        other.m_data = other.m_inline;
+    }
+    other.m_size = 0;
 }
 
 /* private constructors */
 
-String::String(size_t capacity) : m_data(static_cast<ptr>(::operator new(capacity * sizeof(char_type)))), m_capacity(capacity), m_size(0) {}
-
-/* constructors / destructor / assignment operators */
-
-String::String() : m_data(nullptr), m_capacity(0), m_size(0) {}
-
-String::String(ptr_to_const c_string) : String(String::compute_length_of(c_string))
+String::String(size_t capacity) : m_data(m_inline), m_size(0)
 {
-    for (size_t i = 0; i < m_capacity; i += 1)
+    if (capacity > INLINE_CAPACITY)
     {
-        new (m_data + i) char_type(c_string[i]);
+        m_data = static_cast<ptr>(::operator new(capacity * sizeof(char_type)));
+        m_capacity = capacity;
     }
-    m_size = m_capacity;
 }
+
+/* constructors / destructor / assignment operators */
+
+String::String() : m_data(m_inline), m_size(0) {}
+
+String::String(ptr_to_const c_string) : String(StringView(c_string)) {}
 String::String(const StringView& string_view) : String(string_view.size())
 {
-    for (size_t i = 0; i < m_capacity; i += 1)
+    for (size_t i = 0; i < string_view.size(); i += 1)
     {
         new (m_data + i) char_type(string_view[i]);
     }
-    m_size = m_capacity;
+    m_size = string_view.size();
 }
 
-String::String(const String& other) : m_data(static_cast<ptr>(::operator new(other.m_capacity * sizeof(char_type)))), m_capacity(other.m_capacity), m_size(other.m_size)
+String::String(const String& other) : String(other.m_size)
 {
-    for (size_t i = 0; i < m_size; i += 1)
+    for (size_t i = 0; i < other.m_size; i += 1)
     {
         new (m_data + i) char_type(other.m_data[i]);
     }
+    m_size = other.m_size;
 }
-String::String(String&& other) noexcept : m_data(other.m_data), m_capacity(other.m_capacity), m_size(other.m_size)
+String::String(String&& other) noexcept
 {
-    other.m_data = nullptr;
-    other.m_capacity = 0;
-    other.m_size = 0;
+    steal(other);
 }
 String::~String() noexcept
 {
@@ -63,14 +88,19 @@ String& String::operator = (const String& other)
 {
     if (this != &other)
     {
-        free();
-        m_data = static_cast<ptr>(::operator new(other.m_capacity * sizeof(char_type)));
-        m_capacity = other.m_capacity;
-        m_size = other.m_size;
-        for (size_t i = 0; i < m_size; i += 1)
+        // the characters are copied over the old ones if they fit
+        if (other.m_size > capacity())
+        {
+            free();
+            m_data = static_cast<ptr>(::operator new(other.m_size * sizeof(char_type)));
+            m_capacity = other.m_size;
+            m_size = 0;
+        }
+        for (size_t i = 0; i < other.m_size; i += 1)
         {
             new (m_data + i) char_type(other.m_data[i]);
         }
+        m_size = other.m_size;
     }
     return *this;
 }
@@ -79,12 +109,7 @@ String& String::operator = (String&& other) noexcept
     if (this != &other)
     {
         free();
-        m_data = other.m_data;
-        m_capacity = other.m_capacity;
-        m_size = other.m_size;
-        other.m_data = nullptr;
-        other.m_capacity = 0;
-        other.m_size = 0;
+        steal(other);
     }
     return *this;
 }
@@ -135,11 +160,11 @@ String::char_type& String::front()
 }
 size_t String::capacity() const
 {
-    return m_capacity;
+    return is_inline() ? INLINE_CAPACITY : m_capacity;
 }
 bool String::has_zero_capacity() const
 {
-    return m_capacity == 0;
+    return capacity() == 0;
 }
 size_t String::size() const
 {
@@ -281,13 +306,7 @@ String String::slice(size_t start_pos, size_t end_pos_excl) const
 {
     if (start_pos > m_size - 1 or end_pos_excl > m_size or end_pos_excl <= start_pos) return String();
 
-    String substring(end_pos_excl - start_pos);
-    for (size_t i = 0; i < substring.m_capacity; i += 1)
-    {
-        new (substring.m_data + i) char_type(m_data[start_pos + i]);
-    }
-    substring.m_size = substring.m_capacity;
-    return substring;
+    return String(StringView(m_data, start_pos, end_pos_excl));
 }
 String String::substring(size_t start_pos, size_t length) const
 {
@@ -332,17 +351,25 @@ bool String::is_alphanumeric() const
 
 void String::resize_capacity_to(size_t new_capacity)
 {
-    if (new_capacity == m_capacity or new_capacity < m_size) return;
+    if (new_capacity == capacity() or new_capacity < m_size) return;
+    // any capacity that fits inline is served by the inline buffer
+    if (new_capacity <= INLINE_CAPACITY and is_inline()) return;
 
-    ptr new_data = static_cast<ptr>(::operator new(new_capacity * sizeof(char_type)));
+    ptr new_data = new_capacity <= INLINE_CAPACITY ? m_inline : static_cast<ptr>(::operator new(new_capacity * sizeof(char_type)));
     for (size_t i = 0; i < m_size; i += 1)
     {
         new (new_data + i) char_type(m_data[i]);
         m_data[i].~char_type();
     }
-    ::operator delete(m_data);
+    if (not is_inline())
+    {
+        ::operator delete(m_data);
+    }
     m_data = new_data;
-    m_capacity = new_capacity;
+    if (not is_inline())
+    {
+        m_capacity = new_capacity;
+    }
 }
 void String::resize_to(size_t new_size)
 {
@@ -350,7 +377,7 @@ void String::resize_to(size_t new_size)
 
     if (new_size > m_size)
     {
-        if (new_size > m_capacity)
+        if (new_size > capacity())
         {
             resize_capacity_to(new_size);
         }
@@ -402,13 +429,9 @@ String& String::insert(size_t pos, char_type character)
 {
     if (pos > m_size) return *this;
 
-    if (has_zero_capacity())
+    if (m_size + 1 > capacity())
     {
-        resize_capacity_to(1);
-    }
-    if (m_size + 1 > m_capacity)
-    {
-        resize_capacity_to(2 * m_capacity);
+        resize_capacity_to(2 * capacity());
     }
 
     if (pos == m_size)
@@ -437,18 +460,14 @@ String& String::insert(size_t pos, const StringView& string_view)
 {
     if (pos > m_size) return *this;
 
-    if (has_zero_capacity())
-    {
-        resize_capacity_to(string_view.size());
-    }
-    if (m_size + string_view.size() > m_capacity)
+    if (m_size + string_view.size() > capacity())
     {
         size_t multiplier = 2;
-        while (m_size + string_view.size() > multiplier * m_capacity)
+        while (m_size + string_view.size() > multiplier * capacity())
         {
             multiplier *= 2;
         }
-        resize_capacity_to(multiplier * m_capacity);
+        resize_capacity_to(multiplier * capacity());
     }
 
     if (pos == m_size)
@@ -502,7 +521,7 @@ String& String::to_uppercase()
 }
 String& String::to_lowercase()
 {
-    for (char_type i = 0; i < m_size; i += 1)
+    for (size_t i = 0; i < m_size; i += 1)
     {
         if (Char::is_uppercase(m_data[i]))
         {
@@ -783,6 +802,14 @@ bool Char::is_whitespace(char c)
 {
     return c == ' ' or c == '\t' or c == '\n' or c == '\r' or c == '\f' or c == '\v';
 }
+char Char::to_uppercase(char c)
+{
+    return Char::is_lowercase(c) ? c - CASE_DIFF : c;
+}
+char Char::to_lowercase(char c)
+{
+    return Char::is_uppercase(c) ? c + CASE_DIFF : c;
+}
 
 /* compare functions */
 
@@ -832,6 +859,21 @@ strong_ordering compare(const StringView& lhs, const StringView& rhs)
     return strong_ordering::equal;
 }
 
+/* hash functions */
+
+uint64_t case_insensitive_hash(const StringView& string)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < string.size(); i += 1)
+    {
+        char c = Char::is_uppercase(string[i]) ? string[i] + CASE_DIFF : string[i];
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 /* relational operators */
 
 bool operator == (const StringView& lhs, const StringView& rhs)
@@ -11,12 +11,22 @@ public:
     using char_type = char;
     using ptr = char_type*;
     using ptr_to_const = const char_type*;
+
+    // a string of up to this many characters is kept inside the String itself, without allocating
+    static constexpr size_t INLINE_CAPACITY = 16;
 private:
-    ptr m_data;
-    size_t m_capacity;
+    ptr m_data; // points at m_inline while the string is kept inline
     size_t m_size;
+    union
+    {
+        size_t m_capacity; // only while the characters are on the heap
+        char_type m_inline[INLINE_CAPACITY];
+    };
 private:
     void free();
+    bool is_inline() const;
+    // takes the characters of @other, which is left empty
+    void steal(String& other);
 
     String(size_t capacity);
 public:
@@ -150,6 +160,8 @@ namespace Char
     bool is_digit(char character);
     bool is_special(char character);
     bool is_whitespace(char character);
+    char to_uppercase(char character);
+    char to_lowercase(char character);
 };
 
 std::weak_ordering case_insensitive_compare(const char lhs, const char rhs);
@@ -158,6 +170,9 @@ std::weak_ordering case_insensitive_compare(const StringView& lhs, const StringV
 
 std::strong_ordering compare(const StringView& lhs, const StringView& rhs);
 
+// consistent with case_insensitive_compare: strings that compare equivalent hash equal
+uint64_t case_insensitive_hash(const StringView& string);
+
 bool operator == (const StringView& lhs, const StringView& rhs);
 
 std::weak_ordering operator <=> (const StringView& lhs, const StringView& rhs);
@@ -0,0 +1,108 @@
+#include "StringDictionary.hpp"
+
+using namespace std;
+
+void StringDictionary::rehash(size_t slot_count)
+{
+    m_slots = Vector<uint32_t>(slot_count, 0);
+    size_t mask = slot_count - 1;
+    for (size_t i = 0; i < m_values.size(); i += 1)
+    {
+        size_t slot_pos = case_insensitive_hash(m_values[i]->value) & mask;
+        while (m_slots[slot_pos] != 0)
+        {
+            slot_pos = (slot_pos + 1) & mask;
+        }
+        m_slots[slot_pos] = static_cast<uint32_t>(i + 1);
+    }
+}
+
+StringDictionary::StringDictionary() : m_values(), m_class_codes(), m_slots(), m_is_full(false) {}
+
+StringDictionary::StringDictionary(StringDictionary&& other) noexcept : m_values(move(other.m_values)), m_class_codes(move(other.m_class_codes)), m_slots(move(other.m_slots)),
+    m_is_full(other.m_is_full) {}
+StringDictionary& StringDictionary::operator = (StringDictionary&& other) noexcept
+{
+    if (this != &other)
+    {
+        m_values = move(other.m_values);
+        m_class_codes = move(other.m_class_codes);
+        m_slots = move(other.m_slots);
+        m_is_full = other.m_is_full;
+    }
+    return *this;
+}
+
+size_t StringDictionary::size() const
+{
+    return m_values.size();
+}
+bool StringDictionary::is_full() const
+{
+    return m_is_full;
+}
+const StringCell* StringDictionary::value(uint32_t code) const
+{
+    return m_values[code];
+}
+uint32_t StringDictionary::class_code(uint32_t code) const
+{
+    return m_class_codes[code];
+}
+
+StringCell* StringDictionary::intern(StringCell* cell)
+{
+    if (m_is_full) return nullptr;
+    // at most half the slots are taken, so that the runs stay short
+    if (2 * (m_values.size() + 1) > m_slots.size())
+    {
+        rehash(max(2 * m_slots.size(), MIN_SLOT_COUNT));
+    }
+
+    size_t mask = m_slots.size() - 1;
+    size_t slot_pos = case_insensitive_hash(cell->value) & mask;
+    uint32_t class_code = NO_DICTIONARY_CODE;
+    for (; m_slots[slot_pos] != 0; slot_pos = (slot_pos + 1) & mask)
+    {
+        uint32_t code = m_slots[slot_pos] - 1;
+        const String& value = m_values[code]->value;
+        if (compare(StringView(value), StringView(cell->value)) == strong_ordering::equal) return m_values[code];
+        if (class_code == NO_DICTIONARY_CODE and value == cell->value)
+        {
+            class_code = m_class_codes[code];
+        }
+    }
+
+    if (m_values.size() == MAX_SIZE)
+    {
+        m_is_full = true;
+        return nullptr;
+    }
+    uint32_t code = static_cast<uint32_t>(m_values.size());
+    cell->dictionary_code = code;
+    m_values.append(cell);
+    m_class_codes.append(class_code == NO_DICTIONARY_CODE ? code : class_code);
+    m_slots[slot_pos] = code + 1;
+    return cell;
+}
+
+uint32_t StringDictionary::find_class_code(const StringView& value) const
+{
+    if (m_slots.is_empty()) return NO_DICTIONARY_CODE;
+
+    size_t mask = m_slots.size() - 1;
+    for (size_t slot_pos = case_insensitive_hash(value) & mask; m_slots[slot_pos] != 0; slot_pos = (slot_pos + 1) & mask)
+    {
+        uint32_t code = m_slots[slot_pos] - 1;
+        if (m_values[code]->value == value) return m_class_codes[code];
+    }
+    return NO_DICTIONARY_CODE;
+}
+
+void StringDictionary::clear()
+{
+    m_values.clear();
+    m_class_codes.clear();
+    m_slots.clear();
+    m_is_full = false;
+}
\ No newline at end of file
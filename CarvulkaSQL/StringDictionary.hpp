@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Vector.hpp"
+#include "Cell.hpp"
+
+// the distinct values of a STRING column, each kept in a single cell that every row holding the value shares; the cell's dictionary_code
+// is its position in here, so that a condition can be answered once per value and then looked up by code for every row
+// values are kept exactly: strings differing only in case get codes of their own, but share an equivalence class, as compare() finds them equal
+// a column with more distinct values than MAX_SIZE isn't worth encoding; once full, the dictionary takes no more values and the rows keep cells of their own
+// the cells belong to the table's CellPool, the dictionary only refers to them
+class StringDictionary
+{
+public:
+    static constexpr size_t MAX_SIZE = 4096;
+    static constexpr size_t MIN_SLOT_COUNT = 16;
+private:
+    Vector<StringCell*> m_values; // by code
+    Vector<uint32_t> m_class_codes; // by code, the first code given to a value equivalent to it
+    // open addressing on the case-insensitive hash, so that equivalent values probe the same run; code + 1, 0 for an empty slot
+    Vector<uint32_t> m_slots;
+    bool m_is_full;
+private:
+    void rehash(size_t slot_count);
+public:
+    StringDictionary();
+
+    StringDictionary(const StringDictionary& other) = delete;
+    StringDictionary(StringDictionary&& other) noexcept;
+    StringDictionary& operator = (const StringDictionary& other) = delete;
+    StringDictionary& operator = (StringDictionary&& other) noexcept;
+
+    size_t size() const;
+    bool is_full() const;
+    const StringCell* value(uint32_t code) const;
+    uint32_t class_code(uint32_t code) const;
+
+    // returns the shared cell holding exactly the value of @cell; a new value is taken in as @cell itself, which the rows then share
+    // returns nullptr once the dictionary is full, leaving @cell to its row
+    StringCell* intern(StringCell* cell);
+    // the class of the values equivalent to @value, NO_DICTIONARY_CODE if there is none
+    uint32_t find_class_code(const StringView& value) const;
+    // nothing may share the cells any more; they are left to be destroyed by the pool
+    void clear();
+};
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "Table.hpp"
 #include <fstream>
+#include <iomanip>
 
 using namespace std;
 
@@ -28,28 +29,76 @@ void Column::rename_to(String&& new_name)
 
 /* Table */
 
+// a stored row has cells of its own but for those the dictionaries share
+static bool is_owned_by_row(const Cell* cell)
+{
+    return cell == nullptr or cell->data_type != DataType::STRING or static_cast<const StringCell*>(cell)->dictionary_code == NO_DICTIONARY_CODE;
+}
+static void free_stored_row(CellPool& cells, Vector<Cell*>& row)
+{
+    for (size_t i = 0; i < row.size(); i += 1)
+    {
+        if (is_owned_by_row(row[i]))
+        {
+            cells.destroy(row[i]);
+        }
+    }
+}
+
+// the cells go with m_cells
 void Table::free()
 {
-    for (size_t i = 0; i < m_rows.size(); i += 1)
+    delete m_metadata_mutex;
+    delete m_latch;
+}
+void Table::index_column_names()
+{
+    m_column_names.clear();
+    for (size_t i = 0; i < m_columns.size(); i += 1)
     {
-        Table::free_row(m_rows[i]);
+        m_column_names.append(m_columns[i].name());
     }
 }
 
-Table::Table(const StringView& name, const Vector<Column>& columns) : m_name(name), m_columns(columns), m_rows() {}
-Table::Table(const StringView& name, Vector<Column>&& columns) : m_name(name), m_columns(move(columns)), m_rows() {}
-Table::Table(String&& name, const Vector<Column>& columns) : m_name(move(name)), m_columns(columns), m_rows() {}
-Table::Table(String&& name, Vector<Column>&& columns) : m_name(move(name)), m_columns(move(columns)), m_rows() {}
+Table::Table(const StringView& name, const Vector<Column>& columns) : m_name(name), m_columns(columns), m_column_names(), m_rows(), m_cells(), m_next_row_id(0), m_journal_lsn(0), m_deleted_version_count(0),
+    m_metadata_mutex(new mutex()), m_latch(new Latch()), m_statistics(m_columns.size()), m_are_statistics_stale(false), m_analysis(), m_trigram_indexes(), m_dictionaries(m_columns.size())
+{
+    index_column_names();
+}
+Table::Table(const StringView& name, Vector<Column>&& columns) : m_name(name), m_columns(move(columns)), m_column_names(), m_rows(), m_cells(), m_next_row_id(0), m_journal_lsn(0), m_deleted_version_count(0),
+    m_metadata_mutex(new mutex()), m_latch(new Latch()), m_statistics(m_columns.size()), m_are_statistics_stale(false), m_analysis(), m_trigram_indexes(), m_dictionaries(m_columns.size())
+{
+    index_column_names();
+}
+Table::Table(String&& name, const Vector<Column>& columns) : m_name(move(name)), m_columns(columns), m_column_names(), m_rows(), m_cells(), m_next_row_id(0), m_journal_lsn(0), m_deleted_version_count(0),
+    m_metadata_mutex(new mutex()), m_latch(new Latch()), m_statistics(m_columns.size()), m_are_statistics_stale(false), m_analysis(), m_trigram_indexes(), m_dictionaries(m_columns.size())
+{
+    index_column_names();
+}
+Table::Table(String&& name, Vector<Column>&& columns) : m_name(move(name)), m_columns(move(columns)), m_column_names(), m_rows(), m_cells(), m_next_row_id(0), m_journal_lsn(0), m_deleted_version_count(0),
+    m_metadata_mutex(new mutex()), m_latch(new Latch()), m_statistics(m_columns.size()), m_are_statistics_stale(false), m_analysis(), m_trigram_indexes(), m_dictionaries(m_columns.size())
+{
+    index_column_names();
+}
 
-Table::Table(const Table& other) : m_name(other.m_name), m_columns(other.m_columns), m_rows()
+Table::Table(const Table& other) : m_name(other.m_name), m_columns(other.m_columns), m_column_names(other.m_column_names), m_rows(), m_cells(), m_next_row_id(other.m_next_row_id), m_journal_lsn(other.m_journal_lsn), m_deleted_version_count(other.m_deleted_version_count),
+    m_metadata_mutex(new mutex()), m_latch(new Latch()), m_statistics(other.m_statistics), m_are_statistics_stale(other.m_are_statistics_stale), m_analysis(other.m_analysis), m_trigram_indexes(other.m_trigram_indexes),
+    m_dictionaries(m_columns.size())
 {
-    m_rows.resize_capacity_to(other.m_rows.size());
     for (size_t i = 0; i < other.m_rows.size(); i += 1)
     {
-        m_rows.append(move(copy_row_from(other.m_rows[i])));
+        Vector<Cell*> cells = move(copy_row_into_pool(other.m_rows[i].cells));
+        encode_strings_of(cells);
+        m_rows.append(move(cells), other.m_rows[i].version);
     }
 }
-Table::Table(Table&& other) noexcept : m_name(move(other.m_name)), m_columns(move(other.m_columns)), m_rows(move(other.m_rows)) {}
+Table::Table(Table&& other) noexcept : m_name(move(other.m_name)), m_columns(move(other.m_columns)), m_column_names(move(other.m_column_names)), m_rows(move(other.m_rows)), m_cells(move(other.m_cells)), m_next_row_id(other.m_next_row_id), m_journal_lsn(other.m_journal_lsn), m_deleted_version_count(other.m_deleted_version_count),
+    m_metadata_mutex(other.m_metadata_mutex), m_latch(other.m_latch), m_statistics(move(other.m_statistics)), m_are_statistics_stale(other.m_are_statistics_stale), m_analysis(move(other.m_analysis)), m_trigram_indexes(move(other.m_trigram_indexes)),
+    m_dictionaries(move(other.m_dictionaries))
+{
+    other.m_metadata_mutex = nullptr;
+    other.m_latch = nullptr;
+}
 Table::~Table() noexcept
 {
     free();
@@ -58,15 +107,33 @@ Table& Table::operator = (const Table& other)
 {
     if (this != &other)
     {
-        free();
         m_name = other.m_name;
         m_columns = other.m_columns;
-        m_rows = Vector<Vector<Cell*>>();
-        m_rows.resize_capacity_to(other.m_rows.size());
+        m_column_names = other.m_column_names;
+        m_rows = RowStore();
+        m_dictionaries = Vector<StringDictionary>(m_columns.size());
+        m_cells.clear();
         for (size_t i = 0; i < other.m_rows.size(); i += 1)
         {
-            m_rows.append(move(copy_row_from(other.m_rows[i])));
+            Vector<Cell*> cells = move(copy_row_into_pool(other.m_rows[i].cells));
+            encode_strings_of(cells);
+            m_rows.append(move(cells), other.m_rows[i].version);
         }
+        m_next_row_id = other.m_next_row_id;
+        m_journal_lsn = other.m_journal_lsn;
+        m_deleted_version_count = other.m_deleted_version_count;
+        if (m_metadata_mutex == nullptr)
+        {
+            m_metadata_mutex = new mutex();
+        }
+        if (m_latch == nullptr)
+        {
+            m_latch = new Latch();
+        }
+        m_statistics = other.m_statistics;
+        m_are_statistics_stale = other.m_are_statistics_stale;
+        m_analysis = other.m_analysis;
+        m_trigram_indexes = other.m_trigram_indexes;
     }
     return *this;
 }
@@ -74,10 +141,22 @@ Table& Table::operator = (Table&& other) noexcept
 {
     if (this != &other)
     {
-        free();
         m_name = move(other.m_name);
         m_columns = move(other.m_columns);
+        m_column_names = move(other.m_column_names);
         m_rows = move(other.m_rows);
+        m_cells = move(other.m_cells);
+        m_next_row_id = other.m_next_row_id;
+        m_journal_lsn = other.m_journal_lsn;
+        m_deleted_version_count = other.m_deleted_version_count;
+        // the mutexes trade places, so that a moved-from table still has one if it had
+        swap(m_metadata_mutex, other.m_metadata_mutex);
+        swap(m_latch, other.m_latch);
+        m_statistics = move(other.m_statistics);
+        m_are_statistics_stale = other.m_are_statistics_stale;
+        m_analysis = move(other.m_analysis);
+        m_trigram_indexes = move(other.m_trigram_indexes);
+        m_dictionaries = move(other.m_dictionaries);
     }
     return *this;
 }
@@ -99,69 +178,376 @@ Vector<Cell*> Table::copy_row_from(const Vector<Cell*>& src)
     }
     return row;
 }
+Vector<Cell*> Table::copy_row_into_pool(const Vector<Cell*>& src)
+{
+    Vector<Cell*> row(src.size(), nullptr);
+    for (size_t j = 0; j < src.size(); j += 1)
+    {
+        row[j] = m_cells.copy_of(src[j]);
+    }
+    return row;
+}
 
 const Vector<Column>& Table::columns() const
 {
     return m_columns;
 }
-const Vector<Vector<Cell*>>& Table::rows() const
+size_t Table::row_count() const
+{
+    return m_rows.size();
+}
+const Vector<Cell*>& Table::row(size_t row_pos) const
+{
+    return m_rows[row_pos].cells;
+}
+const RowVersion& Table::version(size_t row_pos) const
 {
-    return m_rows;
+    return m_rows[row_pos].version;
 }
 const String& Table::name() const
 {
     return m_name;
 }
+const CellPool& Table::cells() const
+{
+    return m_cells;
+}
+Latch& Table::latch() const
+{
+    return *m_latch;
+}
+LogSequenceNumber Table::journal_lsn() const
+{
+    return m_journal_lsn;
+}
+void Table::set_journal_lsn(LogSequenceNumber lsn)
+{
+    m_journal_lsn = lsn;
+}
+const TableStatistics& Table::refresh_statistics() const
+{
+    if (m_are_statistics_stale)
+    {
+        m_statistics.clear();
+        for (size_t i = 0; i < m_rows.size(); i += 1)
+        {
+            // rows deleted by a transaction still running are left out as well, the statistics are an estimate either way
+            if (not m_rows[i].version.is_deleted())
+            {
+                m_statistics.add_row(m_rows[i].cells);
+            }
+        }
+        m_are_statistics_stale = false;
+    }
+    return m_statistics;
+}
+TableStatistics Table::statistics() const
+{
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    return refresh_statistics();
+}
+TableAnalysis Table::analysis() const
+{
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    return m_analysis;
+}
+double Table::estimate_distinct_count(size_t column_pos) const
+{
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    return refresh_statistics().distinct_count(column_pos);
+}
 
-void Table::save_to(const char* path) const
+Vector<size_t> Table::find_visible_rows(const Snapshot& snapshot) const
+{
+    size_t row_count = m_rows.size();
+    Vector<size_t> row_positions;
+    row_positions.resize_capacity_to(row_count);
+    for (size_t i = 0; i < row_count; i += 1)
+    {
+        if (snapshot.can_see(m_rows[i].version))
+        {
+            row_positions.append(i);
+        }
+    }
+    return row_positions;
+}
+
+// writes @value the way rows are read back
+static void write_value_to(ostream& os, const Cell* value)
+{
+    if (value == nullptr)
+    {
+        os << "null";
+    }
+    else if (value->data_type == DataType::STRING)
+    {
+        os << '\'' << static_cast<const StringCell*>(value)->value << '\'';
+    }
+    else
+    {
+        os << value->convert_to_string();
+    }
+}
+
+void Table::write_row_to(ostream& os, size_t row_pos) const
+{
+    const Vector<Cell*>& row = m_rows[row_pos].cells;
+    for (size_t j = 0; j < row.size(); j += 1)
+    {
+        if (j > 0)
+        {
+            os << " , ";
+        }
+        write_value_to(os, row[j]);
+    }
+    os << '\n';
+}
+void Table::write_column_definitions_to(ostream& os) const
 {
-    ofstream ofs(path);
-    // write name on first line
-    ofs << m_name << '\n';
-    // write column definitions on second line
     for (size_t i = 0; i < m_columns.size(); i += 1)
     {
         if (i == m_columns.size() - 1)
         {
-            ofs << m_columns[i].name() << ' ' << convert_data_type_to_string(m_columns[i].data_type()) << '\n';
+            os << m_columns[i].name() << ' ' << convert_data_type_to_string(m_columns[i].data_type()) << '\n';
         }
         else
         {
-            ofs << m_columns[i].name() << ' ' << convert_data_type_to_string(m_columns[i].data_type()) << " , ";
+            os << m_columns[i].name() << ' ' << convert_data_type_to_string(m_columns[i].data_type()) << " , ";
         }
     }
+}
+
+void Table::save_to(const char* path, const Snapshot& snapshot, LogSequenceNumber lsn) const
+{
+    ofstream ofs(path);
+    // write name on first line
+    ofs << m_name << '\n';
+    // write column definitions on second line
+    write_column_definitions_to(ofs);
     // write rows on every next line
-    for (size_t i = 0; i < m_rows.size(); i += 1)
+    Vector<size_t> row_positions = move(find_visible_rows(snapshot));
+    for (size_t i = 0; i < row_positions.size(); i += 1)
+    {
+        write_row_to(ofs, row_positions[i]);
+    }
+    ofs << "@lsn " << lsn << '\n';
+
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    // write the indexed columns after the rows; the indexes are rebuilt when the table is read back
+    for (size_t i = 0; i < m_trigram_indexes.size(); i += 1)
+    {
+        ofs << "@index " << m_columns[m_trigram_indexes[i].column_pos()].name() << '\n';
+    }
+    // write the analysis after the rows, one short directive per line so that no line outgrows the reader's buffer
+    if (not m_analysis.is_empty())
     {
+        // fractions are read back without exponents
+        ofs << fixed << setprecision(6);
+        ofs << "@analysis " << m_analysis.row_count() << ' ' << m_analysis.sample_size() << '\n';
         for (size_t j = 0; j < m_columns.size(); j += 1)
         {
-            if (j == m_columns.size() - 1)
+            const ColumnDistribution& distribution = m_analysis.columns()[j];
+            ofs << "@column " << m_columns[j].name() << ' ' << distribution.null_fraction() << ' ' << distribution.histogram_fraction() << '\n';
+            for (size_t k = 0; k < distribution.most_common_values().size(); k += 1)
             {
-                if (m_rows[i][j]->data_type == DataType::STRING)
-                {
-                    ofs << '\'' << static_cast<StringCell*>(m_rows[i][j])->value << '\'' << '\n';
-                }
-                else
-                {
-                    ofs << m_rows[i][j]->convert_to_string() << '\n';
-                }
+                ofs << "@mcv ";
+                write_value_to(ofs, distribution.most_common_values()[k]);
+                ofs << ' ' << distribution.most_common_frequencies()[k] << '\n';
             }
-            else
+            for (size_t k = 0; k < distribution.histogram_bounds().size(); k += 1)
             {
-                if (m_rows[i][j]->data_type == DataType::STRING)
-                {
-                    ofs << '\'' << static_cast<StringCell*>(m_rows[i][j])->value << '\'' << " , ";
-                }
-                else
-                {
-                    ofs << m_rows[i][j]->convert_to_string() << " , ";
-                }
+                ofs << "@bound ";
+                write_value_to(ofs, distribution.histogram_bounds()[k]);
+                ofs << '\n';
             }
         }
     }
     ofs.close();
 }
 
+void Table::vacuum(TransactionId horizon)
+{
+    purge_versions_deleted_by(horizon);
+    m_rows.shrink_to_fit();
+    for (size_t i = 0; i < m_trigram_indexes.size(); i += 1)
+    {
+        m_trigram_indexes[i].shrink_to_fit();
+    }
+
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    refresh_statistics();
+}
+
+void Table::analyze(const Snapshot& snapshot)
+{
+    Vector<size_t> row_positions = move(find_visible_rows(snapshot));
+    Vector<const Vector<Cell*>*> rows;
+    rows.resize_capacity_to(row_positions.size());
+    for (size_t i = 0; i < row_positions.size(); i += 1)
+    {
+        rows.append(&m_rows[row_positions[i]].cells);
+    }
+    TableAnalysis analysis = TableAnalysis::analyze(rows, m_columns.size());
+
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    m_analysis = move(analysis);
+}
+void Table::set_analysis(TableAnalysis&& analysis)
+{
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    m_analysis = move(analysis);
+}
+
+double Table::estimate_selectivity(size_t column_pos, const StringView& op, const Cell* value) const
+{
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    const TableStatistics& statistics = refresh_statistics();
+    if (statistics.row_count() == 0) return 1.0;
+
+    const ColumnDistribution* distribution = m_analysis.is_empty() ? nullptr : &m_analysis.columns()[column_pos];
+    double null_fraction = distribution == nullptr ? statistics.null_fraction(column_pos) : distribution->null_fraction();
+    if (op == "is null") return null_fraction;
+    // comparisons with null are unordered, which only '!=' accepts
+    if (value == nullptr) return op == "!=" ? 1.0 : 0.0;
+
+    double non_null_fraction = 1.0 - null_fraction;
+    double equal_fraction = distribution == nullptr ? -1.0 : distribution->estimate_equal_fraction(value, statistics.distinct_count(column_pos));
+    if (equal_fraction < 0.0)
+    {
+        equal_fraction = non_null_fraction / max(1.0, statistics.distinct_count(column_pos));
+    }
+    if (op == "==") return equal_fraction;
+    if (op == "!=") return 1.0 - equal_fraction;
+
+    double less_fraction = 0.0;
+    if (distribution != nullptr and not distribution->histogram_bounds().is_empty())
+    {
+        less_fraction = distribution->estimate_less_fraction(value);
+    }
+    else
+    {
+        const ColumnStatistics& column_statistics = statistics.columns()[column_pos];
+        less_fraction = non_null_fraction * interpolate_between(value, column_statistics.min(), column_statistics.max());
+        if (column_statistics.min() != nullptr and compare(value, column_statistics.min()) != partial_ordering::greater) less_fraction = 0.0;
+        if (column_statistics.max() != nullptr and compare(value, column_statistics.max()) == partial_ordering::greater) less_fraction = non_null_fraction;
+    }
+    less_fraction = min(less_fraction, non_null_fraction);
+
+    if (op == "<") return less_fraction;
+    if (op == "<=") return min(non_null_fraction, less_fraction + equal_fraction);
+    if (op == ">") return max(0.0, non_null_fraction - less_fraction - equal_fraction);
+    if (op == ">=") return max(0.0, non_null_fraction - less_fraction);
+    return 1.0;
+}
+
+TrigramIndex* Table::find_trigram_index(size_t column_pos)
+{
+    for (size_t i = 0; i < m_trigram_indexes.size(); i += 1)
+    {
+        if (m_trigram_indexes[i].column_pos() == column_pos)
+        {
+            return &m_trigram_indexes[i];
+        }
+    }
+    return nullptr;
+}
+const TrigramIndex* Table::find_trigram_index(size_t column_pos) const
+{
+    for (size_t i = 0; i < m_trigram_indexes.size(); i += 1)
+    {
+        if (m_trigram_indexes[i].column_pos() == column_pos)
+        {
+            return &m_trigram_indexes[i];
+        }
+    }
+    return nullptr;
+}
+
+bool Table::is_indexed(size_t column_pos) const
+{
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    return find_trigram_index(column_pos) != nullptr;
+}
+void Table::create_trigram_index(size_t column_pos)
+{
+    if (m_columns.is_empty() or column_pos > m_columns.size() - 1) throw exception("column pos out of bounds");
+    if (m_columns[column_pos].data_type() != DataType::STRING) throw exception("only string columns can be indexed");
+    if (find_trigram_index(column_pos) != nullptr) throw exception("column is already indexed");
+
+    TrigramIndex index(column_pos);
+    index.build(m_rows);
+    m_trigram_indexes.append(move(index));
+}
+void Table::drop_trigram_index(size_t column_pos)
+{
+    for (size_t i = 0; i < m_trigram_indexes.size(); i += 1)
+    {
+        if (m_trigram_indexes[i].column_pos() == column_pos)
+        {
+            m_trigram_indexes.erase(i);
+            return;
+        }
+    }
+    throw exception("column is not indexed");
+}
+bool Table::find_trigram_candidates(size_t column_pos, const StringView& like_pattern, Vector<RowId>& row_ids) const
+{
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    const TrigramIndex* index = find_trigram_index(column_pos);
+    return index != nullptr and index->find_candidates(like_pattern, row_ids);
+}
+
+Vector<bool> Table::evaluate_on_dictionary(size_t column_pos, const Function<bool, Vector<Cell*>>& condition) const
+{
+    if (m_columns.is_empty() or column_pos > m_columns.size() - 1) throw exception("column pos out of bounds");
+
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    const StringDictionary& dictionary = m_dictionaries[column_pos];
+    Vector<bool> results;
+    results.resize_capacity_to(dictionary.size());
+    // a row holding nothing but the value, which is all a condition on the column reads
+    Vector<Cell*> row(m_columns.size(), nullptr);
+    for (uint32_t code = 0; code < dictionary.size(); code += 1)
+    {
+        row[column_pos] = const_cast<StringCell*>(dictionary.value(code));
+        results.append(condition(row));
+    }
+    return results;
+}
+Vector<uint32_t> Table::find_dictionary_class_codes(size_t column_pos) const
+{
+    if (m_columns.is_empty() or column_pos > m_columns.size() - 1) throw exception("column pos out of bounds");
+
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    const StringDictionary& dictionary = m_dictionaries[column_pos];
+    Vector<uint32_t> class_codes;
+    class_codes.resize_capacity_to(dictionary.size());
+    for (uint32_t code = 0; code < dictionary.size(); code += 1)
+    {
+        class_codes.append(dictionary.class_code(code));
+    }
+    return class_codes;
+}
+Vector<uint32_t> Table::translate_dictionary_codes(size_t column_pos, const Table& other, size_t other_column_pos) const
+{
+    if (m_columns.is_empty() or column_pos > m_columns.size() - 1) throw exception("column pos out of bounds");
+    if (other.m_columns.is_empty() or other_column_pos > other.m_columns.size() - 1) throw exception("column pos out of bounds");
+    if (&other == this) return find_dictionary_class_codes(column_pos);
+
+    // both at once, in whatever order keeps two joins of the same tables from waiting on each other
+    scoped_lock lock(*m_metadata_mutex, *other.m_metadata_mutex);
+    const StringDictionary& dictionary = m_dictionaries[column_pos];
+    const StringDictionary& other_dictionary = other.m_dictionaries[other_column_pos];
+    Vector<uint32_t> class_codes;
+    if (other_dictionary.size() == 0) return class_codes;
+    class_codes.resize_capacity_to(dictionary.size());
+    for (uint32_t code = 0; code < dictionary.size(); code += 1)
+    {
+        class_codes.append(other_dictionary.find_class_code(dictionary.value(code)->value));
+    }
+    return class_codes;
+}
+
 void Table::rename_to(const StringView& new_name)
 {
     m_name = new_name;
@@ -175,17 +561,25 @@ void Table::add_column(const Column& column)
 {
     for (size_t i = 0; i < m_rows.size(); i += 1)
     {
-        m_rows[i].append(nullptr);
+        m_rows[i].cells.append(nullptr);
     }
     m_columns.append(column);
+    m_column_names.append(m_columns.back().name());
+    m_statistics.add_column();
+    m_analysis.add_column();
+    m_dictionaries.append(StringDictionary());
 }
 void Table::add_column(Column&& column)
 {
     for (size_t i = 0; i < m_rows.size(); i += 1)
     {
-        m_rows[i].append(nullptr);
+        m_rows[i].cells.append(nullptr);
     }
     m_columns.append(move(column));
+    m_column_names.append(m_columns.back().name());
+    m_statistics.add_column();
+    m_analysis.add_column();
+    m_dictionaries.append(StringDictionary());
 }
 
 void Table::drop_column(size_t column_pos)
@@ -193,32 +587,91 @@ void Table::drop_column(size_t column_pos)
     if (m_columns.is_empty() or column_pos > m_columns.size() - 1) throw exception("column pos out of bounds");
     for (size_t i = 0; i < m_rows.size(); i += 1)
     {
-        delete m_rows[i][column_pos];
-        m_rows[i].erase(column_pos); 
+        if (is_owned_by_row(m_rows[i].cells[column_pos]))
+        {
+            m_cells.destroy(m_rows[i].cells[column_pos]);
+        }
+        m_rows[i].cells.erase(column_pos);
+    }
+    const StringDictionary& dictionary = m_dictionaries[column_pos];
+    for (uint32_t code = 0; code < dictionary.size(); code += 1)
+    {
+        m_cells.destroy(dictionary.value(code));
     }
+    m_dictionaries.erase(column_pos);
     m_columns.erase(column_pos);
+    m_column_names.erase(column_pos);
+    m_statistics.drop_column(column_pos);
+    m_analysis.drop_column(column_pos);
+    for (size_t i = 0; i < m_trigram_indexes.size(); i += 1)
+    {
+        if (m_trigram_indexes[i].column_pos() == column_pos)
+        {
+            m_trigram_indexes.erase(i);
+            i -= 1;
+        }
+        else if (m_trigram_indexes[i].column_pos() > column_pos)
+        {
+            m_trigram_indexes[i].set_column_pos(m_trigram_indexes[i].column_pos() - 1);
+        }
+    }
 }
 
 void Table::rename_column(size_t column_pos, const StringView& new_column_name)
 {
     if (m_columns.is_empty() or column_pos > m_columns.size() - 1) throw exception("column pos out of bounds");
     m_columns[column_pos].rename_to(new_column_name);
+    m_column_names.rename(column_pos, m_columns[column_pos].name());
 }
 void Table::rename_column(size_t column_pos, String&& new_column_name)
 {
     if (m_columns.is_empty() or column_pos > m_columns.size() - 1) throw exception("column pos out of bounds");
     m_columns[column_pos].rename_to(move(new_column_name));
+    m_column_names.rename(column_pos, m_columns[column_pos].name());
 }
 
-void Table::insert(const Vector<Cell*>& row)
+void Table::encode_strings_of(Vector<Cell*>& cells)
+{
+    for (size_t i = 0; i < cells.size(); i += 1)
+    {
+        if (cells[i] == nullptr or cells[i]->data_type != DataType::STRING) continue;
+
+        StringCell* cell = static_cast<StringCell*>(cells[i]);
+        StringCell* shared_cell = m_dictionaries[i].intern(cell);
+        if (shared_cell == nullptr or shared_cell == cell) continue;
+        m_cells.destroy(cell);
+        cells[i] = shared_cell;
+    }
+}
+
+RowId Table::append_version(Vector<Cell*>&& cells, TransactionId created_by)
+{
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    encode_strings_of(cells);
+    m_rows.append(move(cells), RowVersion(m_next_row_id, created_by));
+    m_next_row_id += 1;
+
+    m_statistics.add_row(m_rows.back().cells);
+    for (size_t i = 0; i < m_trigram_indexes.size(); i += 1)
+    {
+        m_trigram_indexes[i].add(m_rows.back().version.row_id, m_rows.back().cells[m_trigram_indexes[i].column_pos()]);
+    }
+    return m_rows.back().version.row_id;
+}
+
+RowId Table::insert(const Vector<Cell*>& row, TransactionId transaction_id)
 {
     if (not is_insertable(row)) throw exception("row is not insertable");
-    m_rows.append(move(copy_row_from(row)));
+    return append_version(move(copy_row_into_pool(row)), transaction_id);
 }
-void Table::insert(Vector<Cell*>&& row)
+RowId Table::insert(Vector<Cell*>&& row, TransactionId transaction_id)
 {
     if (not is_insertable(row)) throw exception("row is not insertable");
-    m_rows.append(move(row));
+    for (size_t i = 0; i < row.size(); i += 1)
+    {
+        row[i] = m_cells.adopt(row[i]);
+    }
+    return append_version(move(row), transaction_id);
 }
 
 bool Table::is_insertable(const Vector<Cell*>& row) const
@@ -241,70 +694,225 @@ bool Table::is_insertable(const Vector<Cell*>& row) const
     return true;
 }
 
-void Table::update(size_t column_pos, const Cell* value)
+void Table::update(size_t column_pos, const Cell* value, const Snapshot& snapshot, Vector<RowChange>& changes)
+{
+    update_if(column_pos, value, [](const Vector<Cell*>& row) -> bool { return true; }, snapshot, changes);
+}
+void Table::update_if(size_t column_pos, const Cell* value, const Function<bool, Vector<Cell*>>& condition, const Snapshot& snapshot, Vector<RowChange>& changes)
 {
     if (m_columns.is_empty() or column_pos > m_columns.size() - 1) throw exception("column pos out of bounds");
-    for (size_t i = 0; i < m_rows.size(); i += 1)
+    // the new versions are appended behind the ones that existed when the update started, and aren't updated again
+    size_t row_count = m_rows.size();
+    for (size_t i = 0; i < row_count; i += 1)
     {
-        delete m_rows[i][column_pos];
-        if (value == nullptr)
-        {
-            m_rows[i][column_pos] = nullptr;
-        }
-        else
+        if (not snapshot.can_see(m_rows[i].version) or not condition(m_rows[i].cells)) continue;
+
+        // the new version shares the cells the dictionaries share as it is, only the others are copied
+        const Vector<Cell*>& src = m_rows[i].cells;
+        Vector<Cell*> cells(src.size(), nullptr);
+        for (size_t j = 0; j < src.size(); j += 1)
         {
-            m_rows[i][column_pos] = value->clone();
+            cells[j] = j == column_pos ? m_cells.copy_of(value) : is_owned_by_row(src[j]) ? m_cells.copy_of(src[j]) : src[j];
         }
+        m_rows[i].version.deleted_by.store(snapshot.own);
+        m_deleted_version_count += 1;
+        changes.append(RowChange{ RowChange::Kind::DELETED, m_rows[i].version.row_id });
+        changes.append(RowChange{ RowChange::Kind::CREATED, append_version(move(cells), snapshot.own) });
     }
+
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    m_are_statistics_stale = true;
 }
-void Table::update_if(size_t column_pos, const Cell* value, const Function<bool, Vector<Cell*>>& condition)
+
+void Table::truncate()
 {
-    if (m_columns.is_empty() or column_pos > m_columns.size() - 1) throw exception("column pos out of bounds");
+    for (size_t i = 0; i < m_dictionaries.size(); i += 1)
+    {
+        m_dictionaries[i].clear();
+    }
+    // every cell goes at once, the slabs with them
+    m_cells.clear();
+    m_rows.truncate_to(0);
+    m_deleted_version_count = 0;
+    m_statistics.clear();
+    m_are_statistics_stale = false;
+    for (size_t i = 0; i < m_trigram_indexes.size(); i += 1)
+    {
+        m_trigram_indexes[i].clear();
+    }
+}
+void Table::delete_rows_if(const Function<bool, Vector<Cell*>>& condition, const Snapshot& snapshot, Vector<RowChange>& changes)
+{
+    bool has_deleted = false;
     for (size_t i = 0; i < m_rows.size(); i += 1)
     {
-        if (condition(m_rows[i]))
+        if (snapshot.can_see(m_rows[i].version) and condition(m_rows[i].cells))
         {
-            delete m_rows[i][column_pos];
-            if (value == nullptr)
-            {
-                m_rows[i][column_pos] = nullptr;
-            }
-            else
-            {
-                m_rows[i][column_pos] = value->clone();
-            }
+            // readers with older snapshots keep seeing the version until it is purged
+            m_rows[i].version.deleted_by.store(snapshot.own);
+            m_deleted_version_count += 1;
+            changes.append(RowChange{ RowChange::Kind::DELETED, m_rows[i].version.row_id });
+            has_deleted = true;
         }
     }
+    if (not has_deleted) return;
+
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    m_are_statistics_stale = true;
+}
+// exact, unlike compare(): strings differing only in case are different values here
+static bool is_same_value(const Cell* lhs, const Cell* rhs)
+{
+    if (lhs == nullptr or rhs == nullptr) return lhs == rhs;
+    if (lhs->data_type != rhs->data_type) return false;
+    switch (lhs->data_type)
+    {
+    case DataType::INTEGER:
+    {
+        return static_cast<const IntegerCell*>(lhs)->value == static_cast<const IntegerCell*>(rhs)->value;
+    }
+    case DataType::REAL:
+    {
+        return static_cast<const RealCell*>(lhs)->value == static_cast<const RealCell*>(rhs)->value;
+    }
+    case DataType::STRING:
+    {
+        StringView lhs_value = static_cast<const StringCell*>(lhs)->value;
+        StringView rhs_value = static_cast<const StringCell*>(rhs)->value;
+        return compare(lhs_value, rhs_value) == strong_ordering::equal;
+    }
+    default:
+    {
+        return false;
+    }
+    }
 }
 
-void Table::truncate()
+bool Table::delete_row_equal_to(const Vector<Cell*>& row, const Snapshot& snapshot, size_t& row_pos)
 {
-    free();
-    m_rows.clear();
+    if (row.size() != m_columns.size()) return false;
+    if (row_pos >= m_rows.size()) row_pos = 0;
+    for (size_t k = 0; k < m_rows.size(); k += 1)
+    {
+        size_t i = row_pos + k < m_rows.size() ? row_pos + k : row_pos + k - m_rows.size();
+        if (not snapshot.can_see(m_rows[i].version)) continue;
+
+        bool is_equal = true;
+        for (size_t j = 0; j < row.size() and is_equal; j += 1)
+        {
+            is_equal = is_same_value(m_rows[i].cells[j], row[j]);
+        }
+        if (not is_equal) continue;
+
+        row_pos = i;
+        m_rows[i].version.deleted_by.store(snapshot.own);
+        m_deleted_version_count += 1;
+
+        lock_guard<mutex> lock(*m_metadata_mutex);
+        m_are_statistics_stale = true;
+        return true;
+    }
+    return false;
 }
-void Table::delete_rows_if(const Function<bool, Vector<Cell*>>& condition)
+void Table::undo(const RowChange& change, TransactionId transaction_id)
 {
+    size_t row_pos = find_row_by_id(change.row_id);
+    if (row_pos == -1) return;
+
+    RowVersion& version = m_rows[row_pos].version;
+    if (change.kind == RowChange::Kind::CREATED)
+    {
+        // a version deleted by the transaction that created it is visible to nobody, and purged like any other
+        if (version.deleted_by.load() != transaction_id)
+        {
+            version.deleted_by.store(transaction_id);
+            m_deleted_version_count += 1;
+        }
+    }
+    else if (version.deleted_by.load() == transaction_id)
+    {
+        version.deleted_by.store(NO_TRANSACTION);
+        m_deleted_version_count -= 1;
+    }
+
+    lock_guard<mutex> lock(*m_metadata_mutex);
+    m_are_statistics_stale = true;
+}
+void Table::purge_versions_deleted_by(TransactionId horizon)
+{
+    if (m_deleted_version_count == 0) return;
+
+    // one compaction pass: kept rows move down over the purged ones, so every row moves at most once
+    Vector<RowId> purged_row_ids;
+    size_t kept_count = 0;
     for (size_t i = 0; i < m_rows.size(); i += 1)
     {
-        if (condition(m_rows[i]))
+        TransactionId deleted_by = m_rows[i].version.deleted_by.load();
+        if (deleted_by != NO_TRANSACTION and deleted_by <= horizon)
         {
-            free_row(m_rows[i]);
-            m_rows.erase(i);
-            i -= 1;
+            free_stored_row(m_cells, m_rows[i].cells);
+            purged_row_ids.append(m_rows[i].version.row_id);
+            continue;
         }
+        if (kept_count != i)
+        {
+            m_rows[kept_count].cells = move(m_rows[i].cells);
+            m_rows[kept_count].version = m_rows[i].version;
+        }
+        kept_count += 1;
+    }
+    if (purged_row_ids.is_empty()) return;
+
+    m_rows.truncate_to(kept_count);
+    m_deleted_version_count -= purged_row_ids.size();
+    m_are_statistics_stale = true;
+    for (size_t i = 0; i < m_trigram_indexes.size(); i += 1)
+    {
+        m_trigram_indexes[i].remove_rows(purged_row_ids);
     }
 }
+bool Table::has_deleted_versions() const
+{
+    return m_deleted_version_count != 0;
+}
 
 size_t Table::find_column_by_name(const StringView& column_name) const
 {
-    for (size_t i = 0; i < m_columns.size(); i += 1)
+    return m_column_names.find(column_name);
+}
+
+size_t Table::find_row_by_id(RowId row_id) const
+{
+    size_t low = 0;
+    size_t high = m_rows.size();
+    while (low < high)
     {
-        if (m_columns[i].name() == column_name)
+        size_t mid = low + (high - low) / 2;
+        if (m_rows[mid].version.row_id < row_id)
         {
-            return i;
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
         }
     }
-    return -1;
+    if (low == m_rows.size() or m_rows[low].version.row_id != row_id) return -1;
+    return low;
+}
+Vector<size_t> Table::find_visible_rows_by_ids(const Vector<RowId>& row_ids, const Snapshot& snapshot) const
+{
+    Vector<size_t> row_positions;
+    row_positions.resize_capacity_to(row_ids.size());
+    for (size_t i = 0; i < row_ids.size(); i += 1)
+    {
+        size_t row_pos = find_row_by_id(row_ids[i]);
+        if (row_pos != -1 and snapshot.can_see(m_rows[row_pos].version))
+        {
+            row_positions.append(row_pos);
+        }
+    }
+    return row_positions;
 }
 
 Vector<size_t> Table::map_column_names_to_indices(const Vector<String>& column_names) const
@@ -326,21 +934,17 @@ Vector<size_t> Table::map_column_names_to_indices(const Vector<String>& column_n
         }
         else
         {
-            for (size_t j = 0; j < m_columns.size(); j += 1)
+            size_t column_pos = m_column_names.find(column_names[i]);
+            // TODO
+            /*
+            if (column_pos != -1 and not column_indices.contains(column_pos))
             {
-                if (column_names[i] == m_columns[j].name())
-                {
-                    // TODO
-                    /*
-                    if (not column_indices.contains(j))
-                    {
-                        column_indices.append(j);
-                        break;
-                    }
-                    */
-                    column_indices.append(j);
-                    break;
-                }
+                column_indices.append(column_pos);
+            }
+            */
+            if (column_pos != -1)
+            {
+                column_indices.append(column_pos);
             }
         }
     }
@@ -349,88 +953,55 @@ Vector<size_t> Table::map_column_names_to_indices(const Vector<String>& column_n
 
 /* AnonymousTable */
 
-AnonymousTable::AnonymousTable(Vector<Column>&& columns, Vector<Vector<Cell*>>&& rows) : m_columns(move(columns)), m_rows(move(rows)) {}
+void AnonymousTable::free()
+{
+    for (size_t i = 0; i < m_rows.size(); i += 1)
+    {
+        Table::free_row(m_rows[i]);
+    }
+}
 
-AnonymousTable::AnonymousTable(const Table& table) : m_columns(table.columns()), m_rows()
+AnonymousTable::AnonymousTable(Vector<Column>&& columns, Vector<Vector<Cell*>>&& rows) : m_columns(move(columns)), m_column_names(), m_rows(move(rows))
 {
     for (size_t i = 0; i < m_columns.size(); i += 1)
     {
-        m_columns[i].rename_to(String(m_columns[i].name()).insert(0, String(table.name()).append('.')));
+        m_column_names.append(m_columns[i].name());
     }
-    m_rows.resize_capacity_to(table.rows().size());
-    for (size_t i = 0; i < table.rows().size(); i += 1)
+}
+
+AnonymousTable::AnonymousTable(AnonymousTable&& other) noexcept : m_columns(move(other.m_columns)), m_column_names(move(other.m_column_names)), m_rows(move(other.m_rows)) {}
+AnonymousTable::~AnonymousTable() noexcept
+{
+    free();
+}
+AnonymousTable& AnonymousTable::operator = (AnonymousTable&& other) noexcept
+{
+    if (this != &other)
     {
-        m_rows.append(move(Table::copy_row_from(table.rows()[i])));
+        free();
+        m_columns = move(other.m_columns);
+        m_column_names = move(other.m_column_names);
+        m_rows = move(other.m_rows);
     }
+    return *this;
 }
 
 const Vector<Column>& AnonymousTable::columns() const
 {
     return m_columns;
 }
-const Vector<Vector<Cell*>>& AnonymousTable::rows() const
+size_t AnonymousTable::row_count() const
 {
-    return m_rows;
+    return m_rows.size();
 }
-
-AnonymousTable AnonymousTable::join(const AnonymousTable& lhs, const AnonymousTable& rhs, const StringView& lhs_column_name, const StringView& rhs_column_name)
+const Vector<Cell*>& AnonymousTable::row(size_t row_pos) const
 {
-    Vector<Column> columns;
-    columns.resize_capacity_to(lhs.columns().size() + rhs.columns().size());
-    columns.append(lhs.columns());
-    columns.append(rhs.columns());
-
-    size_t lhs_column_pos = lhs.find_column_by_name(lhs_column_name);
-    size_t rhs_column_pos = rhs.find_column_by_name(rhs_column_name);
-    if (lhs_column_pos == -1 or rhs_column_pos == -1) throw exception("invalid match condition");
-
-    Vector<Vector<Cell*>> rows;
-    for (size_t i = 0; i < lhs.rows().size(); i += 1)
-    {
-        for (size_t j = 0; j < rhs.rows().size(); j += 1)
-        {
-            if (compare(lhs.rows()[i][lhs_column_pos], rhs.rows()[j][rhs_column_pos]) == partial_ordering::equivalent)
-            {
-                Vector<Cell*> row(lhs.columns().size() + rhs.columns().size());
-                for (size_t k = 0; k < lhs.columns().size(); k += 1)
-                {
-                    if (lhs.rows()[i][k] == nullptr)
-                    {
-                        row[k] = nullptr;
-                    }
-                    else
-                    {
-                        row[k] = lhs.rows()[i][k]->clone();
-                    }
-                }
-                for (size_t m = 0; m < rhs.columns().size(); m += 1)
-                {
-                    if (rhs.rows()[j][m] == nullptr)
-                    {
-                        row[m + lhs.columns().size()] = nullptr;
-                    }
-                    else
-                    {
-                        row[m + lhs.columns().size()] = rhs.rows()[j][m]->clone();
-                    }
-                }
-                rows.append(move(row));
-            }
-        }
-    }
-    return AnonymousTable(move(columns), move(rows));
+    return m_rows[row_pos];
 }
 
 size_t AnonymousTable::find_column_by_name(const StringView& column_name) const
 {
-    for (size_t i = 0; i < m_columns.size(); i += 1)
-    {
-        if (m_columns[i].name() == column_name)
-        {
-            return i;
-        }
-    }
-    return -1;
+    return m_column_names.find(column_name);
 }
 
 Vector<size_t> AnonymousTable::map_column_names_to_indices(const Vector<String>& column_names) const
@@ -452,16 +1023,18 @@ Vector<size_t> AnonymousTable::map_column_names_to_indices(const Vector<String>&
         }
         else
         {
-            for (size_t j = 0; j < m_columns.size(); j += 1)
+            // TODO
+            size_t column_pos = m_column_names.find(column_names[i]);
+            if (column_pos != -1)
             {
-                if (column_names[i] == m_columns[j].name())
-                {
-                    // TODO
-                    column_indices.append(j);
-                    break;
-                }
+                column_indices.append(column_pos);
             }
         }
     }
     return column_indices;
+}
+Vector<bool> AnonymousTable::evaluate_on_dictionary(size_t /*column_pos*/, const Function<bool, Vector<Cell*>>& /*condition*/) const
+{
+    // the rows were copied out of their tables, so no cell has a code
+    return Vector<bool>();
 }
\ No newline at end of file
@@ -3,6 +3,14 @@
 #include "Vector.hpp"
 #include "Cell.hpp"
 #include "Function.hpp"
+#include "Statistics.hpp"
+#include "TrigramIndex.hpp"
+#include "RowStore.hpp"
+#include "StringDictionary.hpp"
+#include "CellPool.hpp"
+#include "NameIndex.hpp"
+#include "Latch.hpp"
+#include <mutex>
 
 class Column
 {
@@ -22,20 +30,59 @@ public:
 
 struct AbstractTable
 {
+    virtual ~AbstractTable() = default;
+
     virtual const Vector<Column>& columns() const = 0;
-    virtual const Vector<Vector<Cell*>>& rows() const = 0;
+    virtual size_t row_count() const = 0;
+    virtual const Vector<Cell*>& row(size_t row_pos) const = 0;
     virtual size_t find_column_by_name(const StringView& column_name) const = 0;
     virtual Vector<size_t> map_column_names_to_indices(const Vector<String>& column_names) const = 0;
+    // answers @condition once per value of the column's dictionary, by code; empty if the column has no dictionary
+    virtual Vector<bool> evaluate_on_dictionary(size_t column_pos, const Function<bool, Vector<Cell*>>& condition) const = 0;
 };
 
+// keeps every version of its rows; a reader picks the versions its snapshot can see, so that it never waits for the writer
+// rows only move when versions are purged or columns change, which the database does while no statement runs
 class Table : public AbstractTable
 {
 private:
     String m_name;
     Vector<Column> m_columns;
-    Vector<Vector<Cell*>> m_rows;
+    NameIndex m_column_names;
+    RowStore m_rows; // row ids ascend with the position
+    // holds every cell of the rows, those the dictionaries share included
+    CellPool m_cells;
+    RowId m_next_row_id;
+    // the last journaled transaction the file the table was read from includes, the journal replays the ones after it
+    LogSequenceNumber m_journal_lsn;
+    // deleted versions still taking up room, for the purge to skip the tables without any
+    size_t m_deleted_version_count;
+    // guards what the writer changes while readers consult it: the statistics, the analysis and the indexes
+    // heap allocated so that the table stays movable
+    mutable std::mutex* m_metadata_mutex;
+    // held shared by the statements reading or writing the rows, exclusively by whatever moves them; on the heap for the same reason
+    mutable Latch* m_latch;
+    // kept up to date by inserts; updates and deletes can't be undone in a HyperLogLog, so they mark it stale until the next read
+    mutable TableStatistics m_statistics;
+    mutable bool m_are_statistics_stale;
+    // empty until the table is analyzed
+    TableAnalysis m_analysis;
+    Vector<TrigramIndex> m_trigram_indexes;
+    // one per column, those of STRING columns share the cells of low-cardinality values among the rows; the writer adds values while readers
+    // consult them, so they are guarded by m_metadata_mutex as well
+    Vector<StringDictionary> m_dictionaries;
 private:
     void free();
+    void index_column_names();
+    // replaces the cells of @cells with the ones the dictionaries share where they can; m_metadata_mutex must be held if readers may be about
+    void encode_strings_of(Vector<Cell*>& cells);
+    // m_metadata_mutex must be held
+    const TableStatistics& refresh_statistics() const;
+    TrigramIndex* find_trigram_index(size_t column_pos);
+    const TrigramIndex* find_trigram_index(size_t column_pos) const;
+    // @cells must be from m_cells
+    RowId append_version(Vector<Cell*>&& cells, TransactionId created_by);
+    Vector<Cell*> copy_row_into_pool(const Vector<Cell*>& row);
 public:
     Table(const StringView& name, const Vector<Column>& columns);
     Table(const StringView& name, Vector<Column>&& columns);
@@ -52,10 +99,49 @@ public:
     static Vector<Cell*> copy_row_from(const Vector<Cell*>& row);
 
     const Vector<Column>& columns() const override;
-    const Vector<Vector<Cell*>>& rows() const override;
+    // every stored version, visible or not
+    size_t row_count() const override;
+    const Vector<Cell*>& row(size_t row_pos) const override;
+    const RowVersion& version(size_t row_pos) const;
     const String& name() const;
-
-    void save_to(const char* path) const;
+    // its counts may be read while the writer changes the rows
+    const CellPool& cells() const;
+    Latch& latch() const;
+    LogSequenceNumber journal_lsn() const;
+    void set_journal_lsn(LogSequenceNumber lsn);
+    TableStatistics statistics() const;
+    TableAnalysis analysis() const;
+    double estimate_distinct_count(size_t column_pos) const;
+
+    // positions of the versions @snapshot can see
+    Vector<size_t> find_visible_rows(const Snapshot& snapshot) const;
+
+    // writes the values of the row at @row_pos on one line, the way rows are read back
+    void write_row_to(std::ostream& os, size_t row_pos) const;
+    // writes the column definitions on one line, the way they are read back
+    void write_column_definitions_to(std::ostream& os) const;
+    // @lsn is the last journaled transaction the rows @snapshot sees include
+    void save_to(const char* path, const Snapshot& snapshot, LogSequenceNumber lsn) const;
+
+    // purges the versions deleted by @horizon or earlier transactions, releases the capacity left behind and brings the statistics up to date
+    void vacuum(TransactionId horizon);
+    void analyze(const Snapshot& snapshot);
+    void set_analysis(TableAnalysis&& analysis);
+    // estimated fraction of the rows satisfying 'column op value', for the relational and 'is null' operators
+    double estimate_selectivity(size_t column_pos, const StringView& op, const Cell* value) const;
+
+    bool is_indexed(size_t column_pos) const;
+    void create_trigram_index(size_t column_pos);
+    void drop_trigram_index(size_t column_pos);
+    // false if the column isn't indexed or the pattern can't narrow the search, see TrigramIndex::find_candidates
+    bool find_trigram_candidates(size_t column_pos, const StringView& like_pattern, Vector<RowId>& row_ids) const;
+
+    Vector<bool> evaluate_on_dictionary(size_t column_pos, const Function<bool, Vector<Cell*>>& condition) const override;
+    // by code, the equivalence class of each value of the column's dictionary; empty if the column has no dictionary
+    Vector<uint32_t> find_dictionary_class_codes(size_t column_pos) const;
+    // by code, the class of the equivalent value in the dictionary of @other's column @other_column_pos, or NO_DICTIONARY_CODE if it has none;
+    // empty if either column has no dictionary
+    Vector<uint32_t> translate_dictionary_codes(size_t column_pos, const Table& other, size_t other_column_pos) const;
 
     void rename_to(const StringView& new_name);
     void rename_to(String&& new_name);
@@ -68,38 +154,61 @@ public:
     void rename_column(size_t column_pos, const StringView& new_column_name);
     void rename_column(size_t column_pos, String&& new_column_name);
 
-    void insert(const Vector<Cell*>& row);
-    void insert(Vector<Cell*>&& row);
+    // returns the id of the new version
+    RowId insert(const Vector<Cell*>& row, TransactionId transaction_id);
+    RowId insert(Vector<Cell*>&& row, TransactionId transaction_id);
 
     bool is_insertable(const Vector<Cell*>& row) const;
 
-    void update(size_t column_pos, const Cell* value);
-    void update_if(size_t column_pos, const Cell* value, const Function<bool, Vector<Cell*>>& condition);
+    // an updated row is deleted and inserted again as a new version, readers with older snapshots keep seeing the old one
+    // the versions created and deleted are appended to @changes, also when a condition throws halfway
+    void update(size_t column_pos, const Cell* value, const Snapshot& snapshot, Vector<RowChange>& changes);
+    void update_if(size_t column_pos, const Cell* value, const Function<bool, Vector<Cell*>>& condition, const Snapshot& snapshot, Vector<RowChange>& changes);
 
     void truncate();
-    void delete_rows_if(const Function<bool, Vector<Cell*>>&);
+    void delete_rows_if(const Function<bool, Vector<Cell*>>& condition, const Snapshot& snapshot, Vector<RowChange>& changes);
+    // deletes one version @snapshot can see holding exactly the values of @row; returns false if there is none
+    // the search starts at @row_pos, wrapping around, and leaves it at the row deleted: rows deleted in order are found in one pass
+    bool delete_row_equal_to(const Vector<Cell*>& row, const Snapshot& snapshot, size_t& row_pos);
+    // undoes a change of @transaction_id: a version it created is deleted by itself, a version it deleted comes back
+    void undo(const RowChange& change, TransactionId transaction_id);
+    // physically removes the versions deleted by @horizon or earlier transactions; moves the rows, so nobody may read them meanwhile
+    void purge_versions_deleted_by(TransactionId horizon);
+    bool has_deleted_versions() const;
 
     size_t find_column_by_name(const StringView& column_name) const override;
+    // -1 if no row has the id
+    size_t find_row_by_id(RowId row_id) const;
+    // positions of the rows with @row_ids, which must be ascending, that @snapshot can see
+    Vector<size_t> find_visible_rows_by_ids(const Vector<RowId>& row_ids, const Snapshot& snapshot) const;
 
     Vector<size_t> map_column_names_to_indices(const Vector<String>& column_names) const override;
 };
 
+// owns its cells
 class AnonymousTable : public AbstractTable
 {
 private:
     Vector<Column> m_columns;
+    NameIndex m_column_names;
     Vector<Vector<Cell*>> m_rows;
-
-    AnonymousTable(Vector<Column>&& columns, Vector<Vector<Cell*>>&& rows);
+private:
+    void free();
 public:
-    AnonymousTable(const Table& table);
+    AnonymousTable(Vector<Column>&& columns, Vector<Vector<Cell*>>&& rows);
+
+    AnonymousTable(const AnonymousTable& other) = delete;
+    AnonymousTable(AnonymousTable&& other) noexcept;
+    ~AnonymousTable() noexcept;
+    AnonymousTable& operator = (const AnonymousTable& other) = delete;
+    AnonymousTable& operator = (AnonymousTable&& other) noexcept;
 
     const Vector<Column>& columns() const override;
-    const Vector<Vector<Cell*>>& rows() const override;
+    size_t row_count() const override;
+    const Vector<Cell*>& row(size_t row_pos) const override;
 
     size_t find_column_by_name(const StringView& column_name) const override;
 
     Vector<size_t> map_column_names_to_indices(const Vector<String>& column_names) const override;
-
-    static AnonymousTable join(const AnonymousTable& lhs, const AnonymousTable& rhs, const StringView& lhs_column_name, const StringView& rhs_column_name);
+    Vector<bool> evaluate_on_dictionary(size_t column_pos, const Function<bool, Vector<Cell*>>& condition) const override;
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "TableFormatter.hpp"
+
+using namespace std;
+
+TableFormatter::TableFormatter(OutputBuffer& output) : m_output(output), m_cell_text(), m_cell_starts(), m_column_count(0) {}
+
+Vector<size_t> TableFormatter::measure_column_names(const Vector<Column>& columns)
+{
+    Vector<size_t> cell_widths;
+    cell_widths.resize_capacity_to(columns.size());
+    for (size_t i = 0; i < columns.size(); i += 1)
+    {
+        cell_widths.append(columns[i].name().size());
+    }
+    return cell_widths;
+}
+
+void TableFormatter::render(const Selection& batch)
+{
+    m_column_count = batch.columns().size();
+    m_cell_text.clear();
+    m_cell_starts.clear();
+    m_cell_starts.append(0);
+    for (size_t i = 0; i < batch.rows().size(); i += 1)
+    {
+        for (size_t j = 0; j < m_column_count; j += 1)
+        {
+            if (batch.rows()[i][j] == nullptr)
+            {
+                m_cell_text.append("NULL");
+            }
+            else
+            {
+                batch.rows()[i][j]->append_to(m_cell_text);
+            }
+            m_cell_starts.append(m_cell_text.size());
+        }
+    }
+}
+
+bool TableFormatter::widen(Vector<size_t>& cell_widths) const
+{
+    bool is_wider = false;
+    for (size_t i = 0; i + 1 < m_cell_starts.size(); i += 1)
+    {
+        size_t width = m_cell_starts[i + 1] - m_cell_starts[i];
+        size_t column_pos = i % m_column_count;
+        if (width > cell_widths[column_pos])
+        {
+            cell_widths[column_pos] = width;
+            is_wider = true;
+        }
+    }
+    return is_wider;
+}
+
+void TableFormatter::write_border(const Vector<size_t>& cell_widths)
+{
+    for (size_t i = 0; i < cell_widths.size(); i += 1)
+    {
+        m_output.append("+-");
+        m_output.append_repeated('-', cell_widths[i]);
+        m_output.append('-');
+    }
+    m_output.append("+\n");
+    m_output.flush_if_full();
+}
+
+void TableFormatter::write_header(const Vector<Column>& columns, const Vector<size_t>& cell_widths)
+{
+    write_border(cell_widths);
+    for (size_t i = 0; i < columns.size(); i += 1)
+    {
+        m_output.append("| ").append(columns[i].name());
+        m_output.append_repeated(' ', cell_widths[i] - columns[i].name().size() + 1);
+    }
+    m_output.append("|\n");
+    write_border(cell_widths);
+}
+
+void TableFormatter::write_rows(const Vector<size_t>& cell_widths)
+{
+    for (size_t i = 0; i + 1 < m_cell_starts.size(); i += 1)
+    {
+        size_t column_pos = i % m_column_count;
+        StringView text(m_cell_text, m_cell_starts[i], m_cell_starts[i + 1]);
+        m_output.append("| ").append(text);
+        m_output.append_repeated(' ', cell_widths[column_pos] - text.size() + 1);
+        if (column_pos + 1 == m_column_count)
+        {
+            m_output.append("|\n");
+            m_output.flush_if_full();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Selection.hpp"
+#include "OutputBuffer.hpp"
+
+// writes selections as the console's boxed tables, a batch of rows at a time
+// every cell of a batch is rendered once, for both measuring and printing its column
+class TableFormatter
+{
+private:
+    OutputBuffer& m_output;
+    // the text of the cells of the rendered batch, row by row; cell i spans [m_cell_starts[i], m_cell_starts[i + 1])
+    String m_cell_text;
+    Vector<size_t> m_cell_starts;
+    size_t m_column_count;
+public:
+    TableFormatter(OutputBuffer& output);
+
+    // the narrowest widths the columns can have, those of their names
+    static Vector<size_t> measure_column_names(const Vector<Column>& columns);
+
+    // renders the cells of @batch, in place of the batch rendered before
+    void render(const Selection& batch);
+    // widens @cell_widths to fit the rendered cells; returns whether any of them widened
+    bool widen(Vector<size_t>& cell_widths) const;
+
+    // +-...-+
+    void write_border(const Vector<size_t>& cell_widths);
+    void write_header(const Vector<Column>& columns, const Vector<size_t>& cell_widths);
+    // | ... | for each rendered row
+    void write_rows(const Vector<size_t>& cell_widths);
+};
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "TrigramIndex.hpp"
+#include <algorithm>
+
+using namespace std;
+
+/* PostingList */
+
+TrigramIndex::PostingList::PostingList(uint32_t trigram) : trigram(trigram), row_count(0), last_row_id(0), encoded_row_ids() {}
+
+void TrigramIndex::PostingList::append(RowId row_id)
+{
+    RowId delta = row_count == 0 ? row_id : row_id - last_row_id;
+    // 7 bits per byte, the high bit marks that another byte follows
+    while (delta >= 0x80)
+    {
+        encoded_row_ids.append(static_cast<uint8_t>(delta | 0x80));
+        delta >>= 7;
+    }
+    encoded_row_ids.append(static_cast<uint8_t>(delta));
+    row_count += 1;
+    last_row_id = row_id;
+}
+
+Vector<RowId> TrigramIndex::PostingList::decode() const
+{
+    Vector<RowId> row_ids;
+    row_ids.resize_capacity_to(row_count);
+    RowId row_id = 0;
+    size_t pos = 0;
+    while (pos < encoded_row_ids.size())
+    {
+        RowId delta = 0;
+        uint8_t shift = 0;
+        while (encoded_row_ids[pos] & 0x80)
+        {
+            delta |= static_cast<RowId>(encoded_row_ids[pos] & 0x7f) << shift;
+            shift += 7;
+            pos += 1;
+        }
+        delta |= static_cast<RowId>(encoded_row_ids[pos]) << shift;
+        pos += 1;
+
+        row_id += delta;
+        row_ids.append(row_id);
+    }
+    return row_ids;
+}
+
+TrigramIndex::PostingList TrigramIndex::PostingList::encode(uint32_t trigram, const Vector<RowId>& row_ids)
+{
+    PostingList posting_list(trigram);
+    for (size_t i = 0; i < row_ids.size(); i += 1)
+    {
+        posting_list.append(row_ids[i]);
+    }
+    return posting_list;
+}
+
+/* TrigramIndex */
+
+TrigramIndex::TrigramIndex(size_t column_pos) : m_column_pos(column_pos), m_posting_lists() {}
+
+Vector<uint32_t> TrigramIndex::extract_trigrams_from(const StringView& string)
+{
+    Vector<uint32_t> trigrams;
+    if (string.size() < 3) return trigrams;
+
+    trigrams.resize_capacity_to(string.size() - 2);
+    for (size_t i = 0; i + 2 < string.size(); i += 1)
+    {
+        uint32_t trigram = static_cast<uint32_t>(static_cast<unsigned char>(Char::to_lowercase(string[i]))) << 16
+            | static_cast<uint32_t>(static_cast<unsigned char>(Char::to_lowercase(string[i + 1]))) << 8
+            | static_cast<uint32_t>(static_cast<unsigned char>(Char::to_lowercase(string[i + 2])));
+        trigrams.append(trigram);
+    }
+    sort(trigrams.data(), trigrams.data() + trigrams.size());
+    size_t unique_count = unique(trigrams.data(), trigrams.data() + trigrams.size()) - trigrams.data();
+    trigrams.resize_to(unique_count);
+    return trigrams;
+}
+
+size_t TrigramIndex::lower_bound(uint32_t trigram) const
+{
+    size_t low = 0;
+    size_t high = m_posting_lists.size();
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (m_posting_lists[mid].trigram < trigram)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+TrigramIndex::PostingList& TrigramIndex::find_or_insert(uint32_t trigram)
+{
+    size_t pos = lower_bound(trigram);
+    if (pos == m_posting_lists.size() or m_posting_lists[pos].trigram != trigram)
+    {
+        m_posting_lists.insert(pos, PostingList(trigram));
+    }
+    return m_posting_lists[pos];
+}
+const TrigramIndex::PostingList* TrigramIndex::find(uint32_t trigram) const
+{
+    size_t pos = lower_bound(trigram);
+    if (pos == m_posting_lists.size() or m_posting_lists[pos].trigram != trigram) return nullptr;
+    return &m_posting_lists[pos];
+}
+
+size_t TrigramIndex::column_pos() const
+{
+    return m_column_pos;
+}
+void TrigramIndex::set_column_pos(size_t column_pos)
+{
+    m_column_pos = column_pos;
+}
+size_t TrigramIndex::size_in_bytes() const
+{
+    size_t size = m_posting_lists.capacity() * sizeof(PostingList);
+    for (size_t i = 0; i < m_posting_lists.size(); i += 1)
+    {
+        size += m_posting_lists[i].encoded_row_ids.capacity();
+    }
+    return size;
+}
+
+void TrigramIndex::build(const RowStore& rows)
+{
+    clear();
+    for (size_t i = 0; i < rows.size(); i += 1)
+    {
+        add(rows[i].version.row_id, rows[i].cells[m_column_pos]);
+    }
+}
+
+void TrigramIndex::add(RowId row_id, const Cell* value)
+{
+    if (value == nullptr or value->data_type != DataType::STRING) return;
+
+    Vector<uint32_t> trigrams = move(extract_trigrams_from(static_cast<const StringCell*>(value)->value));
+    for (size_t i = 0; i < trigrams.size(); i += 1)
+    {
+        find_or_insert(trigrams[i]).append(row_id);
+    }
+}
+
+void TrigramIndex::remove_rows(const Vector<RowId>& deleted_row_ids)
+{
+    if (deleted_row_ids.is_empty()) return;
+
+    for (size_t i = 0; i < m_posting_lists.size(); i += 1)
+    {
+        Vector<RowId> row_ids = move(m_posting_lists[i].decode());
+        Vector<RowId> remaining_row_ids;
+        remaining_row_ids.resize_capacity_to(row_ids.size());
+        // both lists are ascending, so one merge pass finds the deleted rows
+        size_t deleted_pos = 0;
+        for (size_t j = 0; j < row_ids.size(); j += 1)
+        {
+            while (deleted_pos < deleted_row_ids.size() and deleted_row_ids[deleted_pos] < row_ids[j])
+            {
+                deleted_pos += 1;
+            }
+            if (deleted_pos < deleted_row_ids.size() and deleted_row_ids[deleted_pos] == row_ids[j]) continue;
+            remaining_row_ids.append(row_ids[j]);
+        }
+
+        if (remaining_row_ids.size() == row_ids.size()) continue;
+        if (remaining_row_ids.is_empty())
+        {
+            m_posting_lists.erase(i);
+            i -= 1;
+        }
+        else
+        {
+            m_posting_lists[i] = PostingList::encode(m_posting_lists[i].trigram, remaining_row_ids);
+        }
+    }
+}
+
+void TrigramIndex::clear()
+{
+    m_posting_lists.clear();
+}
+void TrigramIndex::shrink_to_fit()
+{
+    m_posting_lists.resize_capacity_to(m_posting_lists.size());
+    for (size_t i = 0; i < m_posting_lists.size(); i += 1)
+    {
+        m_posting_lists[i].encoded_row_ids.resize_capacity_to(m_posting_lists[i].encoded_row_ids.size());
+    }
+}
+
+bool TrigramIndex::find_candidates(const StringView& like_pattern, Vector<RowId>& row_ids) const
+{
+    Vector<uint32_t> trigrams;
+    size_t literal_start_pos = 0;
+    for (size_t i = 0; i <= like_pattern.size(); i += 1)
+    {
+        if (i < like_pattern.size() and like_pattern[i] != '%' and like_pattern[i] != '_') continue;
+
+        trigrams.append(extract_trigrams_from(like_pattern.slice(literal_start_pos, i)));
+        literal_start_pos = i + 1;
+    }
+    if (trigrams.is_empty()) return false;
+
+    // intersect starting from the shortest list, so that the candidates only shrink from there
+    Vector<const PostingList*> posting_lists;
+    for (size_t i = 0; i < trigrams.size(); i += 1)
+    {
+        const PostingList* posting_list = find(trigrams[i]);
+        if (posting_list == nullptr)
+        {
+            row_ids.clear();
+            return true;
+        }
+        posting_lists.append(posting_list);
+    }
+    sort(posting_lists.data(), posting_lists.data() + posting_lists.size(), [](const PostingList* lhs, const PostingList* rhs) -> bool { return lhs->row_count < rhs->row_count; });
+
+    row_ids = move(posting_lists[0]->decode());
+    for (size_t i = 1; i < posting_lists.size() and not row_ids.is_empty(); i += 1)
+    {
+        Vector<RowId> other_row_ids = move(posting_lists[i]->decode());
+        size_t kept_count = 0;
+        size_t other_pos = 0;
+        for (size_t j = 0; j < row_ids.size(); j += 1)
+        {
+            while (other_pos < other_row_ids.size() and other_row_ids[other_pos] < row_ids[j])
+            {
+                other_pos += 1;
+            }
+            if (other_pos < other_row_ids.size() and other_row_ids[other_pos] == row_ids[j])
+            {
+                row_ids[kept_count] = row_ids[j];
+                kept_count += 1;
+            }
+        }
+        row_ids.resize_to(kept_count);
+    }
+    return true;
+}
\ No newline at end of file
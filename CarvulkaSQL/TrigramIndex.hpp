@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Vector.hpp"
+#include "Cell.hpp"
+#include "RowStore.hpp"
+
+// an inverted index from every lowercased three character substring of a STRING column to the rows containing it
+// narrows the candidates of 'is like' to the rows containing all trigrams of the pattern's literal parts
+class TrigramIndex
+{
+private:
+    // row ids ascending, stored as varint encoded deltas
+    struct PostingList
+    {
+        uint32_t trigram;
+        size_t row_count;
+        RowId last_row_id;
+        Vector<uint8_t> encoded_row_ids;
+
+        PostingList(uint32_t trigram = 0);
+
+        void append(RowId row_id);
+        Vector<RowId> decode() const;
+        static PostingList encode(uint32_t trigram, const Vector<RowId>& row_ids);
+    };
+private:
+    size_t m_column_pos;
+    Vector<PostingList> m_posting_lists; // sorted by trigram
+private:
+    // position of @trigram's list, or of where it would be inserted
+    size_t lower_bound(uint32_t trigram) const;
+    PostingList& find_or_insert(uint32_t trigram);
+    const PostingList* find(uint32_t trigram) const;
+public:
+    TrigramIndex(size_t column_pos);
+
+    // sorted, without duplicates
+    static Vector<uint32_t> extract_trigrams_from(const StringView& string);
+
+    size_t column_pos() const;
+    void set_column_pos(size_t column_pos);
+    size_t size_in_bytes() const;
+
+    // indexes every stored version, the visible ones are picked by whoever reads the candidates
+    void build(const RowStore& rows);
+    // rows must be added in ascending row id order; an updated row is added again as its new version
+    void add(RowId row_id, const Cell* value);
+    // @deleted_row_ids must be ascending; row ids are stable, so no other entry changes
+    void remove_rows(const Vector<RowId>& deleted_row_ids);
+    void clear();
+    void shrink_to_fit();
+
+    // returns false if the pattern has no literal part of three or more characters to narrow the search with
+    bool find_candidates(const StringView& like_pattern, Vector<RowId>& row_ids) const;
+};
\ No newline at end of file
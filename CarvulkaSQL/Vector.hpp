@@ -1,7 +1,23 @@
 #pragma once
 
+#include "Arena.hpp"
 #include <utility>
 #include <exception>
+#include <type_traits>
+#include <cstring>
+
+template<typename T>
+class Vector;
+template<typename T>
+class VectorView;
+
+// whether an object may be moved to another address by copying its bytes, the old one then being forgotten without destructing it;
+// true for the trivially copyable types and for vectors, and may be declared for other types whose objects don't point into themselves
+// (a String doesn't qualify, it points into itself while inline)
+template<typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+template<typename T>
+struct is_trivially_relocatable<Vector<T>> : std::true_type {};
 
 template<typename T>
 class Vector
@@ -14,33 +30,119 @@ private:
     ptr m_data;
     size_t m_capacity;
     size_t m_size;
+    // nullptr for memory from the heap; memory from an arena isn't given back, the arena takes all of it back at once
+    Arena* m_arena;
 private:
+    ptr allocate(size_t capacity)
+    {
+        if (m_arena != nullptr) return static_cast<ptr>(m_arena->allocate(capacity * sizeof(type), alignof(type)));
+        return static_cast<ptr>(::operator new(capacity * sizeof(type)));
+    }
+    void deallocate(ptr data)
+    {
+        if (m_arena == nullptr and data != nullptr)
+        {
+            ::operator delete(data);
+        }
+    }
     void free()
     {
-        for (size_t i = 0; i < m_size; i += 1)
+        destruct(m_data, m_size);
+        deallocate(m_data);
+    }
+    static void destruct(ptr data, size_t count)
+    {
+        if constexpr (not std::is_trivially_destructible_v<type>)
         {
-            m_data[i].~type();
+            for (size_t i = 0; i < count; i += 1)
+            {
+                data[i].~type();
+            }
         }
-        ::operator delete(m_data);
+    }
+    // moves @count objects from @src to @dst, which may overlap; @dst is left holding them and @src unconstructed
+    static void relocate(ptr dst, ptr src, size_t count)
+    {
+        if (count == 0 or dst == src) return;
+        if constexpr (is_trivially_relocatable<type>::value)
+        {
+            std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(type));
+        }
+        else if (dst < src)
+        {
+            for (size_t i = 0; i < count; i += 1)
+            {
+                new (dst + i) type(std::move(src[i]));
+                src[i].~type();
+            }
+        }
+        else
+        {
+            for (size_t i = count; i > 0; i -= 1)
+            {
+                new (dst + i - 1) type(std::move(src[i - 1]));
+                src[i - 1].~type();
+            }
+        }
+    }
+    // constructs copies of the @count objects at @src into the unconstructed @dst
+    static void copy_construct(ptr dst, ptr_to_const src, size_t count)
+    {
+        if constexpr (std::is_trivially_copyable_v<type>)
+        {
+            if (count != 0)
+            {
+                std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(type));
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i += 1)
+            {
+                new (dst + i) type(src[i]);
+            }
+        }
+    }
+    // leaves @count unconstructed slots at @pos, the objects from @pos on moved behind them, growing to at least twice the capacity if they don't fit
+    // returns the buffer given up by growing, nullptr if there was room, for the caller to deallocate once the new objects are in;
+    // the objects moved no longer hold their values, so new objects must not be copied from the vector's own
+    ptr open_gap(size_t pos, size_t count)
+    {
+        if (m_size + count <= m_capacity)
+        {
+            relocate(m_data + pos + count, m_data + pos, m_size - pos);
+            return nullptr;
+        }
+
+        size_t new_capacity = m_size + count > 2 * m_capacity ? m_size + count : 2 * m_capacity;
+        ptr new_data = allocate(new_capacity);
+        relocate(new_data, m_data, pos);
+        relocate(new_data + pos + count, m_data + pos, m_size - pos);
+        ptr old_data = m_data;
+        m_data = new_data;
+        m_capacity = new_capacity;
+        return old_data;
     }
 public:
-    Vector() : m_data(nullptr), m_capacity(0), m_size(0) {}
+    Vector() : m_data(nullptr), m_capacity(0), m_size(0), m_arena(nullptr) {}
+    // allocates from @arena, which must outlive the vector and everything it's moved into; copies allocate from the heap
+    explicit Vector(Arena* arena) : m_data(nullptr), m_capacity(0), m_size(0), m_arena(arena) {}
 
-    Vector(size_t size) : m_data(static_cast<ptr>(::operator new(size * sizeof(type)))), m_capacity(size), m_size(size)
+    Vector(size_t size) : m_data(static_cast<ptr>(::operator new(size * sizeof(type)))), m_capacity(size), m_size(size), m_arena(nullptr)
     {
         for (size_t i = 0; i < m_capacity; i += 1)
         {
             new (m_data + i) type();
         }
     }
-    Vector(size_t size, const type& object) : m_data(static_cast<ptr>(::operator new(size * sizeof(type)))), m_capacity(size), m_size(size)
+    Vector(size_t size, const type& object) : m_data(static_cast<ptr>(::operator new(size * sizeof(type)))), m_capacity(size), m_size(size), m_arena(nullptr)
     {
         for (size_t i = 0; i < m_capacity; i += 1)
         {
             new (m_data + i) type(object);
         }
     }
-    Vector(std::initializer_list<type> il) : m_data(static_cast<ptr>(::operator new(il.size() * sizeof(type)))), m_capacity(il.size()), m_size(il.size())
+    Vector(std::initializer_list<type> il) : m_data(static_cast<ptr>(::operator new(il.size() * sizeof(type)))), m_capacity(il.size()), m_size(il.size()), m_arena(nullptr)
     {
         for (size_t i = 0; i < m_capacity; i += 1)
         {
@@ -48,14 +150,15 @@ public:
         }
     }
 
-    Vector(const Vector<type>& other) : m_data(static_cast<ptr>(::operator new(other.m_capacity * sizeof(type)))), m_capacity(other.m_capacity), m_size(other.m_size)
+    Vector(const Vector<type>& other) : m_data(static_cast<ptr>(::operator new(other.m_capacity * sizeof(type)))), m_capacity(other.m_capacity), m_size(other.m_size), m_arena(nullptr)
     {
-        for (size_t i = 0; i < m_size; i += 1)
-        {
-            new (m_data + i) type(other.m_data[i]);
-        }
+        copy_construct(m_data, other.m_data, m_size);
+    }
+    explicit Vector(const VectorView<type>& view) : m_data(static_cast<ptr>(::operator new(view.size() * sizeof(type)))), m_capacity(view.size()), m_size(view.size()), m_arena(nullptr)
+    {
+        copy_construct(m_data, view.data(), m_size);
     }
-    Vector(Vector<type>&& other) noexcept : m_data(other.m_data), m_capacity(other.m_capacity), m_size(other.m_size)
+    Vector(Vector<type>&& other) noexcept : m_data(other.m_data), m_capacity(other.m_capacity), m_size(other.m_size), m_arena(other.m_arena)
     {
         other.m_data = nullptr;
         other.m_capacity = 0;
@@ -70,13 +173,10 @@ public:
         if (this != &other)
         {
             free();
-            m_data = static_cast<ptr>(::operator new(other.m_capacity * sizeof(type)));
+            m_data = allocate(other.m_capacity);
             m_capacity = other.m_capacity;
             m_size = other.m_size;
-            for (size_t i = 0; i < m_size; i += 1)
-            {
-                new (m_data + i) type(other.m_data[i]);
-            }
+            copy_construct(m_data, other.m_data, m_size);
         }
         return *this;
     }
@@ -88,6 +188,7 @@ public:
             m_data = other.m_data;
             m_capacity = other.m_capacity;
             m_size = other.m_size;
+            m_arena = other.m_arena;
             other.m_data = nullptr;
             other.m_capacity = 0;
             other.m_size = 0;
@@ -217,11 +318,10 @@ public:
     {
         if (start_pos > m_size - 1 or end_pos_excl > m_size or end_pos_excl <= start_pos) return Vector<type>();
 
-        Vector<type> subvector(end_pos_excl - start_pos);
-        for (size_t i = 0; i < subvector.m_capacity; i += 1)
-        {
-            new (subvector.m_data + i) type(m_data[start_pos + i]);
-        }
+        Vector<type> subvector;
+        subvector.m_data = subvector.allocate(end_pos_excl - start_pos);
+        subvector.m_capacity = end_pos_excl - start_pos;
+        copy_construct(subvector.m_data, m_data + start_pos, subvector.m_capacity);
         subvector.m_size = subvector.m_capacity;
         return subvector;
     }
@@ -229,214 +329,97 @@ public:
     {
         return slice(start_pos, start_pos + length);
     }
+    // like slice(), but refers to the objects instead of copying them; the view is valid as long as the vector isn't changed
+    VectorView<type> view(size_t start_pos, size_t end_pos_excl) const
+    {
+        return VectorView<type>(*this).slice(start_pos, end_pos_excl);
+    }
 
     Vector<type>& insert(size_t pos, const type& object)
     {
         if (pos > m_size) return *this;
+        // opening the gap would move the object to copy
+        if (&object >= m_data and &object < m_data + m_size) return insert(pos, type(object));
 
-        if (has_zero_capacity())
-        {
-            resize_capacity_to(1);
-        }
-        if (m_size + 1 > m_capacity)
-        {
-            resize_capacity_to(2 * m_capacity);
-        }
-
-        if (pos == m_size)
-        {
-            new (m_data + m_size) type(object);
-        }
-        else
-        {
-            for (size_t i = m_size; i >= pos + 1; i -= 1)
-            {
-                if (i >= m_size)
-                {
-                    new (m_data + i) type(std::move(m_data[i - 1]));
-                }
-                else
-                {
-                    m_data[i] = std::move(m_data[i - 1]);
-                }
-            }
-            m_data[pos] = object;
-        }
+        ptr old_data = open_gap(pos, 1);
+        new (m_data + pos) type(object);
+        deallocate(old_data);
         m_size += 1;
         return *this;
     }
     Vector<type>& insert(size_t pos, type&& object)
     {
         if (pos > m_size) return *this;
+        // opening the gap would move the object to move from
+        if (&object >= m_data and &object < m_data + m_size) return insert(pos, type(std::move(object)));
 
-        if (has_zero_capacity())
-        {
-            resize_capacity_to(1);
-        }
-        if (m_size + 1 > m_capacity)
-        {
-            resize_capacity_to(2 * m_capacity);
-        }
-
-        if (pos == m_size)
-        {
-            new (m_data + m_size) type(std::move(object));
-        }
-        else
-        {
-            for (size_t i = m_size; i >= pos + 1; i -= 1)
-            {
-                if (i >= m_size)
-                {
-                    new (m_data + i) type(std::move(m_data[i - 1]));
-                }
-                else
-                {
-                    m_data[i] = std::move(m_data[i - 1]);
-                }
-            }
-            m_data[pos] = std::move(object);
-        }
+        ptr old_data = open_gap(pos, 1);
+        new (m_data + pos) type(std::move(object));
+        deallocate(old_data);
         m_size += 1;
         return *this;
     }
     Vector<type>& insert(size_t pos, const Vector<type>& vector)
+    {
+        return insert(pos, VectorView<type>(vector));
+    }
+    Vector<type>& insert(size_t pos, const VectorView<type>& view)
     {
         if (pos > m_size) return *this;
+        // the gap would open in the middle of the objects to copy
+        if (view.data() >= m_data and view.data() < m_data + m_size) return insert(pos, Vector<type>(view));
 
-        if (has_zero_capacity())
-        {
-            resize_capacity_to(vector.size());
-        }
-        if (m_size + vector.size() > m_capacity)
-        {
-            size_t multiplier = 2;
-            while (m_size + vector.size() > multiplier * m_capacity)
-            {
-                multiplier *= 2;
-            }
-            resize_capacity_to(multiplier * m_capacity);
-        }
-
-        if (pos == m_size)
-        {
-            for (size_t i = 0; i < vector.size(); i += 1)
-            {
-                new (m_data + m_size + i) type(vector[i]);
-            }
-        }
-        else
-        {
-            for (size_t i = m_size - 1 + vector.size(); i >= pos + vector.size(); i -= 1)
-            {
-                if (i >= m_size)
-                {
-                    new (m_data + i) type(std::move(m_data[i - vector.size()]));
-                }
-                else
-                {
-                    m_data[i] = std::move(m_data[i - vector.size()]);
-                }
-            }
-            for (size_t i = 0; i < vector.size(); i += 1)
-            {
-                m_data[i + pos] = vector[i];
-            }
-        }
-        m_size += vector.size();
+        ptr old_data = open_gap(pos, view.size());
+        copy_construct(m_data + pos, view.data(), view.size());
+        deallocate(old_data);
+        m_size += view.size();
         return *this;
     }
     Vector<type>& insert(size_t pos, Vector<type>&& vector)
     {
         if (pos > m_size) return *this;
 
-        if (has_zero_capacity())
-        {
-            resize_capacity_to(vector.size());
-        }
-        if (m_size + vector.size() > m_capacity)
-        {
-            size_t multiplier = 2;
-            while (m_size + vector.size() > multiplier * m_capacity)
-            {
-                multiplier *= 2;
-            }
-            resize_capacity_to(multiplier * m_capacity);
-        }
-
-        if (pos == m_size)
-        {
-            for (size_t i = 0; i < vector.size(); i += 1)
-            {
-                new (m_data + m_size + i) type(std::move(vector[i]));
-            }
-        }
-        else
-        {
-            for (size_t i = m_size - 1 + vector.size(); i >= pos + vector.size(); i -= 1)
-            {
-                if (i >= m_size)
-                {
-                    new (m_data + i) type(std::move(m_data[i - vector.size()]));
-                }
-                else
-                {
-                    m_data[i] = std::move(m_data[i - vector.size()]);
-                }
-            }
-            for (size_t i = 0; i < vector.size(); i += 1)
-            {
-                m_data[i + pos] = std::move(vector[i]);
-            }
-        }
-        m_size += vector.size();
+        ptr old_data = open_gap(pos, vector.m_size);
+        relocate(m_data + pos, vector.m_data, vector.m_size);
+        deallocate(old_data);
+        m_size += vector.m_size;
+        // its objects are gone, only its memory is left
+        vector.m_size = 0;
         return *this;
     }
     Vector<type>& insert(size_t pos, std::initializer_list<type> il)
     {
         if (pos > m_size) return *this;
 
-        if (has_zero_capacity())
+        ptr old_data = open_gap(pos, il.size());
+        for (size_t i = 0; i < il.size(); i += 1)
         {
-            resize_capacity_to(il.size());
+            new (m_data + pos + i) type(std::move(il.begin()[i]));
         }
-        if (m_size + il.size() > m_capacity)
-        {
-            size_t multiplier = 2;
-            while (m_size + il.size() > multiplier * m_capacity)
-            {
-                multiplier *= 2;
-            }
-            resize_capacity_to(multiplier * m_capacity);
-        }
-
-        if (pos == m_size)
+        deallocate(old_data);
+        m_size += il.size();
+        return *this;
+    }
+    // constructs the object at the end from @args, in place; when growing, before the objects are moved, as @args may refer to them
+    template<typename... Args>
+    type& emplace_back(Args&&... args)
+    {
+        if (m_size < m_capacity)
         {
-            for (size_t i = 0; i < il.size(); i += 1)
-            {
-                new (m_data + m_size + i) type(std::move(il.begin()[i]));
-            }
+            new (m_data + m_size) type(std::forward<Args>(args)...);
         }
         else
         {
-            for (size_t i = m_size - 1 + il.size(); i >= pos + il.size(); i -= 1)
-            {
-                if (i >= m_size)
-                {
-                    new (m_data + i) type(std::move(m_data[i - il.size()]));
-                }
-                else
-                {
-                    m_data[i] = std::move(m_data[i - il.size()]);
-                }
-            }
-            for (size_t i = 0; i < il.size(); i += 1)
-            {
-                m_data[i + pos] = std::move(il.begin()[i]);
-            }
+            size_t new_capacity = m_size + 1 > 2 * m_capacity ? m_size + 1 : 2 * m_capacity;
+            ptr new_data = allocate(new_capacity);
+            new (new_data + m_size) type(std::forward<Args>(args)...);
+            relocate(new_data, m_data, m_size);
+            deallocate(m_data);
+            m_data = new_data;
+            m_capacity = new_capacity;
         }
-        m_size += il.size();
-        return *this;
+        m_size += 1;
+        return m_data[m_size - 1];
     }
 
     Vector<type>& append(const type& object)
@@ -451,6 +434,10 @@ public:
     {
         return insert(m_size, vector);
     }
+    Vector<type>& append(const VectorView<type>& view)
+    {
+        return insert(m_size, view);
+    }
     Vector<type>& append(Vector<type>&& vector)
     {
         return insert(m_size, std::move(vector));
@@ -467,16 +454,20 @@ public:
     {
         if (new_capacity == m_capacity or new_capacity < m_size) return;
 
-        ptr new_data = static_cast<ptr>(::operator new(new_capacity * sizeof(type)));
-        for (size_t i = 0; i < m_size; i += 1)
-        {
-            new (new_data + i) type(std::move(m_data[i]));
-            m_data[i].~type();
-        }
-        ::operator delete(m_data);
+        ptr new_data = allocate(new_capacity);
+        relocate(new_data, m_data, m_size);
+        deallocate(m_data);
         m_data = new_data;
         m_capacity = new_capacity;
     }
+    // grows the capacity to @min_capacity if it's less; never shrinks it
+    void reserve(size_t min_capacity)
+    {
+        if (min_capacity > m_capacity)
+        {
+            resize_capacity_to(min_capacity);
+        }
+    }
     // if @new_size < size, default-constructed objects up to the new size are appended; if @new_size > size, existing objects from and beyond the new size are destructed
     // @param
     // new_size: does nothing if equal to current size
@@ -498,10 +489,7 @@ public:
         }
         else
         {
-            for (size_t i = new_size; i < m_size; i += 1)
-            {
-                m_data[i].~type();
-            }
+            destruct(m_data + new_size, m_size - new_size);
         }
         m_size = new_size;
     }
@@ -517,14 +505,8 @@ public:
             count = m_size - pos;
         }
 
-        for (size_t i = pos; i < m_size - count; i += 1)
-        {
-            m_data[i] = std::move(m_data[i + count]);
-        }
-        for (size_t i = 0; i < count; i += 1)
-        {
-            m_data[m_size - count + i].~type();
-        }
+        destruct(m_data + pos, count);
+        relocate(m_data + pos, m_data + pos + count, m_size - pos - count);
         m_size -= count;
     }
     void pop()
@@ -532,4 +514,104 @@ public:
         m_data[m_size - 1].~type();
         m_size -= 1;
     }
+};
+
+// a range of objects held by someone else, passed around as a pointer and a size instead of a copy; like StringView, it's only valid as long as
+// the objects it refers to don't move, so a view of a vector must not outlive it or any change to it
+template<typename T>
+class VectorView
+{
+public:
+    using type = T;
+    using ptr = type*;
+    using ptr_to_const = const type*;
+private:
+    ptr_to_const m_data;
+    size_t m_size;
+public:
+    VectorView() : m_data(nullptr), m_size(0) {}
+    VectorView(const Vector<type>& vector) : m_data(vector.data()), m_size(vector.size()) {}
+    VectorView(ptr_to_const data, size_t size) : m_data(data), m_size(size) {}
+    VectorView(const Vector<type>& vector, size_t start_pos, size_t end_pos_excl) : m_data(vector.data() + start_pos), m_size(end_pos_excl - start_pos) {}
+
+    ptr_to_const data() const
+    {
+        return m_data;
+    }
+    const type& operator [] (size_t pos) const
+    {
+        return m_data[pos];
+    }
+    const type& at(size_t pos) const
+    {
+        if (pos > m_size - 1) throw std::exception("pos out of bounds");
+        return m_data[pos];
+    }
+    const type& back() const
+    {
+        return m_data[m_size - 1];
+    }
+    const type& front() const
+    {
+        return m_data[0];
+    }
+    size_t size() const
+    {
+        return m_size;
+    }
+    bool is_empty() const
+    {
+        return m_size == 0;
+    }
+
+    size_t find(const type& object) const
+    {
+        for (size_t i = 0; i < m_size; i += 1)
+        {
+            if (object == m_data[i])
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+    size_t rev_find(const type& object) const
+    {
+        for (size_t i = m_size - 1; i >= 0 and i != -1; i -= 1)
+        {
+            if (object == m_data[i])
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+    size_t find_in_interval(const type& object, size_t start_pos, size_t end_pos_excl) const
+    {
+        if (start_pos > m_size - 1 or end_pos_excl > m_size) return -1;
+
+        for (size_t i = start_pos; i < end_pos_excl; i += 1)
+        {
+            if (object == m_data[i])
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+    bool contains(const type& object) const
+    {
+        return find(object) != -1;
+    }
+
+    VectorView<type> slice(size_t start_pos, size_t end_pos_excl) const
+    {
+        if (start_pos > m_size - 1 or end_pos_excl > m_size or end_pos_excl <= start_pos) return VectorView<type>();
+
+        return VectorView<type>(m_data + start_pos, end_pos_excl - start_pos);
+    }
+    VectorView<type> subview(size_t start_pos, size_t length) const
+    {
+        return slice(start_pos, start_pos + length);
+    }
 };
\ No newline at end of file
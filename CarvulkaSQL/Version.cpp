@@ -0,0 +1,77 @@
+#include "Version.hpp"
+
+using namespace std;
+
+/* RowVersion */
+
+RowVersion::RowVersion() : row_id(0), created_by(NO_TRANSACTION), deleted_by(NO_TRANSACTION) {}
+RowVersion::RowVersion(RowId row_id, TransactionId created_by) : row_id(row_id), created_by(created_by), deleted_by(NO_TRANSACTION) {}
+
+RowVersion::RowVersion(const RowVersion& other) : row_id(other.row_id), created_by(other.created_by), deleted_by(other.deleted_by.load()) {}
+RowVersion& RowVersion::operator = (const RowVersion& other)
+{
+    if (this != &other)
+    {
+        row_id = other.row_id;
+        created_by = other.created_by;
+        deleted_by.store(other.deleted_by.load());
+    }
+    return *this;
+}
+
+bool RowVersion::is_deleted() const
+{
+    return deleted_by.load() != NO_TRANSACTION;
+}
+
+/* Snapshot */
+
+bool Snapshot::can_see(const RowVersion& version) const
+{
+    if (version.created_by > horizon and version.created_by != own) return false;
+    TransactionId deleted_by = version.deleted_by.load();
+    return deleted_by == NO_TRANSACTION or (deleted_by > horizon and deleted_by != own);
+}
+
+/* TransactionManager */
+
+TransactionManager::TransactionManager() : m_last_finished_id(NO_TRANSACTION), m_writer_mutex(), m_writer_finished(), m_is_writing(false), m_is_writer_open(false) {}
+
+TransactionId TransactionManager::last_finished_id() const
+{
+    return m_last_finished_id.load();
+}
+
+Snapshot TransactionManager::take_snapshot() const
+{
+    return Snapshot{ m_last_finished_id.load(), NO_TRANSACTION };
+}
+Snapshot TransactionManager::begin_write(bool is_open)
+{
+    TransactionId last_finished_id = NO_TRANSACTION;
+    {
+        unique_lock<mutex> lock(m_writer_mutex);
+        // an open writer may also take over while waiting for a statement's
+        m_writer_finished.wait(lock, [this]() -> bool { return not m_is_writing or m_is_writer_open; });
+        if (m_is_writing) throw exception("another transaction is in progress");
+        m_is_writing = true;
+        m_is_writer_open = is_open;
+        last_finished_id = m_last_finished_id.load();
+    }
+    // the writers waiting meanwhile give up rather than wait for it
+    if (is_open)
+    {
+        m_writer_finished.notify_all();
+    }
+    return Snapshot{ last_finished_id, last_finished_id + 1 };
+}
+void TransactionManager::finish_write(const Snapshot& snapshot)
+{
+    {
+        lock_guard<mutex> lock(m_writer_mutex);
+        m_last_finished_id.store(snapshot.own);
+        m_is_writing = false;
+        m_is_writer_open = false;
+    }
+    m_writer_finished.notify_one();
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+// identifies a version of a row; an update stores the new values as a new version with an id of its own
+using RowId = uint64_t;
+// every statement that changes data runs as a transaction; ids are handed out in increasing order, starting from 1
+using TransactionId = uint64_t;
+
+constexpr TransactionId NO_TRANSACTION = 0;
+// numbers the committed transactions in the journal; a saved table records the last one it includes
+using LogSequenceNumber = uint64_t;
+
+// the version metadata kept alongside every row
+struct RowVersion
+{
+    RowId row_id;
+    TransactionId created_by;
+    // NO_TRANSACTION while the version is live; stamped by the writer while readers may be checking it
+    std::atomic<TransactionId> deleted_by;
+
+    RowVersion();
+    RowVersion(RowId row_id, TransactionId created_by);
+
+    RowVersion(const RowVersion& other);
+    RowVersion& operator = (const RowVersion& other);
+
+    bool is_deleted() const;
+};
+
+// what a statement reads: the versions of every transaction up to @horizon, which had all finished when it started, plus its own
+struct Snapshot
+{
+    TransactionId horizon;
+    TransactionId own; // NO_TRANSACTION for readers
+
+    bool can_see(const RowVersion& version) const;
+};
+
+// a version a transaction created or deleted, for undoing it
+struct RowChange
+{
+    enum class Kind : uint8_t
+    {
+        CREATED,
+        DELETED
+    };
+
+    Kind kind;
+    RowId row_id;
+};
+
+// hands out transaction ids and snapshots; one transaction writes at a time, while readers never wait for it
+class TransactionManager
+{
+private:
+    // transactions finish in the order their ids were handed out, so a single id tells which of them are done
+    std::atomic<TransactionId> m_last_finished_id;
+    // not a mutex held by the writer: a transaction may begin and finish on different threads
+    std::mutex m_writer_mutex;
+    std::condition_variable m_writer_finished;
+    bool m_is_writing;
+    // the writer is a transaction left open between statements, which only its session's next statement finishes
+    bool m_is_writer_open;
+public:
+    TransactionManager();
+
+    TransactionManager(const TransactionManager& other) = delete;
+    TransactionManager& operator = (const TransactionManager& other) = delete;
+
+    TransactionId last_finished_id() const;
+
+    Snapshot take_snapshot() const;
+    // waits for the running writer to finish, if there is one; throws instead if it is left open between statements, since the statement finishing it
+    // may need the very thread that would wait for it
+    // @param
+    // is_open: whether the new writer is left open between statements
+    Snapshot begin_write(bool is_open = false);
+    // committed or rolled back alike, the transaction's versions are final once it finishes
+    void finish_write(const Snapshot& snapshot);
+};
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "WireProtocol.hpp"
+#include <cstring>
+
+using namespace std;
+
+// the payload's size isn't known until it's encoded, so the header is reserved first and filled in by end_frame
+static size_t begin_frame(Vector<uint8_t>& buffer, FrameType type)
+{
+    size_t header_pos = buffer.size();
+    append_uint32_to(buffer, 0);
+    buffer.append(static_cast<uint8_t>(type));
+    return header_pos;
+}
+static void end_frame(Vector<uint8_t>& buffer, size_t header_pos)
+{
+    uint32_t payload_size = static_cast<uint32_t>(buffer.size() - header_pos - FRAME_HEADER_SIZE);
+    for (size_t i = 0; i < 4; i += 1)
+    {
+        buffer[header_pos + i] = static_cast<uint8_t>(payload_size >> (8 * i));
+    }
+}
+
+void append_uint32_to(Vector<uint8_t>& buffer, uint32_t value)
+{
+    for (size_t i = 0; i < 4; i += 1)
+    {
+        buffer.append(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+void append_uint64_to(Vector<uint8_t>& buffer, uint64_t value)
+{
+    for (size_t i = 0; i < 8; i += 1)
+    {
+        buffer.append(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+void append_string_to(Vector<uint8_t>& buffer, const StringView& string)
+{
+    append_uint32_to(buffer, static_cast<uint32_t>(string.size()));
+    for (size_t i = 0; i < string.size(); i += 1)
+    {
+        buffer.append(static_cast<uint8_t>(string[i]));
+    }
+}
+void append_cell_to(Vector<uint8_t>& buffer, const Cell* cell)
+{
+    if (cell == nullptr)
+    {
+        buffer.append(static_cast<uint8_t>(DataType::INVALID));
+        return;
+    }
+
+    buffer.append(static_cast<uint8_t>(cell->data_type));
+    if (cell->data_type == DataType::INTEGER)
+    {
+        append_uint64_to(buffer, static_cast<uint64_t>(static_cast<const IntegerCell*>(cell)->value));
+    }
+    else if (cell->data_type == DataType::REAL)
+    {
+        uint64_t bits;
+        memcpy(&bits, &static_cast<const RealCell*>(cell)->value, sizeof(bits));
+        append_uint64_to(buffer, bits);
+    }
+    else
+    {
+        append_string_to(buffer, static_cast<const StringCell*>(cell)->value);
+    }
+}
+
+uint32_t read_uint32_from(const uint8_t* bytes)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; i += 1)
+    {
+        value |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+uint64_t read_uint64_from(const uint8_t* bytes)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; i += 1)
+    {
+        value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+void append_request_frame_to(Vector<uint8_t>& buffer, const StringView& statement)
+{
+    append_string_to(buffer, statement);
+}
+
+void append_columns_frame_to(Vector<uint8_t>& buffer, const Vector<Column>& columns)
+{
+    size_t header_pos = begin_frame(buffer, FrameType::COLUMNS);
+    append_uint32_to(buffer, static_cast<uint32_t>(columns.size()));
+    for (size_t i = 0; i < columns.size(); i += 1)
+    {
+        buffer.append(static_cast<uint8_t>(columns[i].data_type()));
+        append_string_to(buffer, columns[i].name());
+    }
+    end_frame(buffer, header_pos);
+}
+
+void append_rows_frames_to(Vector<uint8_t>& buffer, const Selection& batch)
+{
+    const Vector<Vector<Cell*>>& rows = batch.rows();
+    for (size_t first_row_pos = 0; first_row_pos < rows.size(); first_row_pos += ROWS_PER_FRAME)
+    {
+        size_t row_count = min(ROWS_PER_FRAME, rows.size() - first_row_pos);
+        size_t header_pos = begin_frame(buffer, FrameType::ROWS);
+        append_uint32_to(buffer, static_cast<uint32_t>(row_count));
+        for (size_t i = first_row_pos; i < first_row_pos + row_count; i += 1)
+        {
+            for (size_t j = 0; j < rows[i].size(); j += 1)
+            {
+                append_cell_to(buffer, rows[i][j]);
+            }
+        }
+        end_frame(buffer, header_pos);
+    }
+}
+
+void append_columnar_frame_to(Vector<uint8_t>& buffer, const Selection& batch)
+{
+    const Vector<Column>& columns = batch.columns();
+    const Vector<Vector<Cell*>>& rows = batch.rows();
+    // room for everything but the bytes of the strings, since growing to an exact size reallocates every time
+    size_t fixed_size = FRAME_HEADER_SIZE + 5 + columns.size() * ((rows.size() + 7) / 8 + 8 * rows.size() + 4);
+    if (buffer.size() + fixed_size > buffer.capacity())
+    {
+        buffer.resize_capacity_to(max(2 * buffer.capacity(), buffer.size() + fixed_size));
+    }
+    size_t header_pos = begin_frame(buffer, FrameType::COLUMNAR);
+    append_uint32_to(buffer, static_cast<uint32_t>(rows.size()));
+    for (size_t j = 0; j < columns.size(); j += 1)
+    {
+        DataType data_type = columns[j].data_type();
+        size_t bitmap_pos = buffer.size();
+        buffer.resize_to(bitmap_pos + (rows.size() + 7) / 8);
+        for (size_t i = 0; i < rows.size(); i += 1)
+        {
+            if (rows[i][j] != nullptr and rows[i][j]->data_type == data_type)
+            {
+                buffer[bitmap_pos + i / 8] |= 1 << (i % 8);
+            }
+        }
+
+        if (data_type == DataType::STRING)
+        {
+            // the offsets are filled in as the bytes are appended behind them
+            size_t offsets_pos = buffer.size();
+            buffer.resize_to(offsets_pos + 4 * (rows.size() + 1));
+            size_t bytes_pos = buffer.size();
+            for (size_t i = 0; i <= rows.size(); i += 1)
+            {
+                uint32_t offset = static_cast<uint32_t>(buffer.size() - bytes_pos);
+                for (size_t k = 0; k < 4; k += 1)
+                {
+                    buffer[offsets_pos + 4 * i + k] = static_cast<uint8_t>(offset >> (8 * k));
+                }
+                if (i == rows.size() or rows[i][j] == nullptr or rows[i][j]->data_type != data_type) continue;
+                const String& value = static_cast<const StringCell*>(rows[i][j])->value;
+                for (size_t k = 0; k < value.size(); k += 1)
+                {
+                    buffer.append(static_cast<uint8_t>(value[k]));
+                }
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < rows.size(); i += 1)
+        {
+            uint64_t bits = 0;
+            if (rows[i][j] != nullptr and rows[i][j]->data_type == DataType::INTEGER and data_type == DataType::INTEGER)
+            {
+                bits = static_cast<uint64_t>(static_cast<const IntegerCell*>(rows[i][j])->value);
+            }
+            else if (rows[i][j] != nullptr and rows[i][j]->data_type == DataType::REAL and data_type == DataType::REAL)
+            {
+                memcpy(&bits, &static_cast<const RealCell*>(rows[i][j])->value, sizeof(bits));
+            }
+            append_uint64_to(buffer, bits);
+        }
+    }
+    end_frame(buffer, header_pos);
+}
+
+void append_status_frame_to(Vector<uint8_t>& buffer, bool is_error, const StringView& message)
+{
+    size_t header_pos = begin_frame(buffer, FrameType::STATUS);
+    buffer.append(static_cast<uint8_t>(is_error ? 1 : 0));
+    for (size_t i = 0; i < message.size(); i += 1)
+    {
+        buffer.append(static_cast<uint8_t>(message[i]));
+    }
+    end_frame(buffer, header_pos);
+}
+
+size_t read_frame_size(const Vector<uint8_t>& buffer)
+{
+    if (buffer.size() < FRAME_HEADER_SIZE) return -1;
+    return read_uint32_from(buffer.data());
+}
+bool has_complete_frame(const Vector<uint8_t>& buffer)
+{
+    size_t frame_size = read_frame_size(buffer);
+    return frame_size != -1 and buffer.size() - FRAME_HEADER_SIZE >= frame_size;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Selection.hpp"
+#include <cstdint>
+
+// every message on a connection is a frame: the size of its payload as 4 bytes little-endian, then the payload
+// a client sends one statement per frame, as text without the terminating ';'; the server answers every statement in order,
+// with a COLUMNS frame and any number of ROWS frames if it selected rows, then always with a STATUS frame
+// a session whose output is set to binary gets COLUMNAR frames in place of ROWS frames
+// the payload of every frame the server sends starts with its type
+enum class FrameType : uint8_t
+{
+    COLUMNS = 1,  // the column count (4 bytes), then per column its DataType (1 byte) and its name
+    ROWS = 2,     // the row count (4 bytes), then every cell of every row
+    STATUS = 3,   // 0 on success or 1 on error (1 byte), then the message
+    COLUMNAR = 4  // the row count (4 bytes), then the values column by column, see append_columnar_frame_to
+};
+// integers are little-endian; a string is its size (4 bytes) then its bytes; a cell is its DataType (1 byte, INVALID for null),
+// then an INTEGER as 8 bytes, a REAL as the 8 bytes of its IEEE 754 representation, or a STRING as a string
+
+constexpr size_t FRAME_HEADER_SIZE = 4;
+// larger requests are refused, so that a client can't make the server buffer without bound
+constexpr size_t MAX_REQUEST_SIZE = 1 << 20;
+// a selection is sent in frames of this many rows, so that a client can start reading before all of it is encoded
+constexpr size_t ROWS_PER_FRAME = 256;
+
+void append_uint32_to(Vector<uint8_t>& buffer, uint32_t value);
+void append_uint64_to(Vector<uint8_t>& buffer, uint64_t value);
+void append_string_to(Vector<uint8_t>& buffer, const StringView& string);
+void append_cell_to(Vector<uint8_t>& buffer, const Cell* cell);
+
+uint32_t read_uint32_from(const uint8_t* bytes);
+uint64_t read_uint64_from(const uint8_t* bytes);
+
+void append_request_frame_to(Vector<uint8_t>& buffer, const StringView& statement);
+void append_columns_frame_to(Vector<uint8_t>& buffer, const Vector<Column>& columns);
+// as many ROWS frames as the rows of @batch take
+void append_rows_frames_to(Vector<uint8_t>& buffer, const Selection& batch);
+// per column, a validity bitmap of a bit per row, least significant first, set if the value isn't null; then for an INTEGER
+// or REAL column 8 bytes per row, zero for nulls, and for a STRING column the row count + 1 offsets (4 bytes each) at
+// which each row's bytes start, then the bytes; a cell of another type than its column's is sent as null
+void append_columnar_frame_to(Vector<uint8_t>& buffer, const Selection& batch);
+void append_status_frame_to(Vector<uint8_t>& buffer, bool is_error, const StringView& message);
+
+// returns the payload size of the frame at the start of @buffer, or -1 until its header has arrived
+size_t read_frame_size(const Vector<uint8_t>& buffer);
+// whether the frame at the start of @buffer has arrived in full
+bool has_complete_frame(const Vector<uint8_t>& buffer);
\ No newline at end of file